@@ -0,0 +1,505 @@
+#include "raylib.h"
+
+#include "aabb_tree.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------------
+// Box helpers
+//----------------------------------------------------------------------------------
+// Inclusive overlap so zero width query boxes (vertical probes) still hit
+bool BoxesOverlap(Rectangle a, Rectangle b)
+{
+    return (a.x <= b.x + b.width) && (b.x <= a.x + a.width) &&
+           (a.y <= b.y + b.height) && (b.y <= a.y + a.height);
+}
+
+bool BoxContains(Rectangle outer, Rectangle inner)
+{
+    return (outer.x <= inner.x) && (outer.y <= inner.y) &&
+           (inner.x + inner.width <= outer.x + outer.width) &&
+           (inner.y + inner.height <= outer.y + outer.height);
+}
+
+Rectangle BoxUnion(Rectangle a, Rectangle b)
+{
+    float minX = fminf(a.x, b.x);
+    float minY = fminf(a.y, b.y);
+    float maxX = fmaxf(a.x + a.width, b.x + b.width);
+    float maxY = fmaxf(a.y + a.height, b.y + b.height);
+
+    return (Rectangle){minX, minY, maxX - minX, maxY - minY};
+}
+
+static float BoxPerimeter(Rectangle box)
+{
+    return 2.0f*(box.width + box.height);
+}
+
+// Slab test, fraction is the entry point along the segment (0 when start is inside)
+bool SegmentBoxFraction(Vector2 start, Vector2 end, Rectangle box, float maxFraction, float *fraction)
+{
+    float tMin = 0.0f;
+    float tMax = maxFraction;
+    float origin[2] = {start.x, start.y};
+    float delta[2] = {end.x - start.x, end.y - start.y};
+    float boxMin[2] = {box.x, box.y};
+    float boxMax[2] = {box.x + box.width, box.y + box.height};
+
+    for (int axis = 0; axis < 2; axis++)
+    {
+        if (fabsf(delta[axis]) < 1e-9f)
+        {
+            if ((origin[axis] < boxMin[axis]) || (origin[axis] > boxMax[axis])) return false;
+        }
+        else
+        {
+            float inv = 1.0f/delta[axis];
+            float t1 = (boxMin[axis] - origin[axis])*inv;
+            float t2 = (boxMax[axis] - origin[axis])*inv;
+
+            if (t1 > t2)
+            {
+                float swap = t1;
+                t1 = t2;
+                t2 = swap;
+            }
+
+            tMin = fmaxf(tMin, t1);
+            tMax = fminf(tMax, t2);
+
+            if (tMin > tMax) return false;
+        }
+    }
+
+    if (fraction != NULL) *fraction = tMin;
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------
+// Node pool
+//----------------------------------------------------------------------------------
+static int AllocateNode(AabbTree *tree)
+{
+    if (tree->freeList == AABB_TREE_NULL)
+    {
+        int oldCapacity = tree->capacity;
+        tree->capacity = (oldCapacity == 0)? 16 : oldCapacity*2;
+        tree->nodes = (AabbTreeNode *)realloc(tree->nodes, tree->capacity*sizeof(AabbTreeNode));
+
+        for (int i = oldCapacity; i < tree->capacity; i++)
+        {
+            tree->nodes[i].parent = (i < tree->capacity - 1)? i + 1 : AABB_TREE_NULL;
+            tree->nodes[i].height = -1;
+        }
+
+        tree->freeList = oldCapacity;
+    }
+
+    int nodeId = tree->freeList;
+    AabbTreeNode *node = &tree->nodes[nodeId];
+    tree->freeList = node->parent;
+    node->parent = AABB_TREE_NULL;
+    node->child1 = AABB_TREE_NULL;
+    node->child2 = AABB_TREE_NULL;
+    node->height = 0;
+    node->userData = -1;
+    tree->count++;
+
+    return nodeId;
+}
+
+static void FreeNode(AabbTree *tree, int nodeId)
+{
+    tree->nodes[nodeId].parent = tree->freeList;
+    tree->nodes[nodeId].height = -1;
+    tree->freeList = nodeId;
+    tree->count--;
+}
+
+//----------------------------------------------------------------------------------
+// Structure maintenance
+//----------------------------------------------------------------------------------
+// Rotates the tree at node a when its children heights differ by more than one,
+// returns the new root of the subtree
+static int Balance(AabbTree *tree, int iA)
+{
+    AabbTreeNode *nodes = tree->nodes;
+    AabbTreeNode *a = &nodes[iA];
+
+    if ((a->height < 2) || (a->child1 == AABB_TREE_NULL)) return iA;
+
+    int iB = a->child1;
+    int iC = a->child2;
+    AabbTreeNode *b = &nodes[iB];
+    AabbTreeNode *c = &nodes[iC];
+    int balance = c->height - b->height;
+
+    // Rotate C up
+    if (balance > 1)
+    {
+        int iF = c->child1;
+        int iG = c->child2;
+        AabbTreeNode *f = &nodes[iF];
+        AabbTreeNode *g = &nodes[iG];
+
+        c->child1 = iA;
+        c->parent = a->parent;
+        a->parent = iC;
+
+        if (c->parent != AABB_TREE_NULL)
+        {
+            if (nodes[c->parent].child1 == iA) nodes[c->parent].child1 = iC;
+            else nodes[c->parent].child2 = iC;
+        }
+        else tree->root = iC;
+
+        if (f->height > g->height)
+        {
+            c->child2 = iF;
+            a->child2 = iG;
+            g->parent = iA;
+            a->box = BoxUnion(b->box, g->box);
+            c->box = BoxUnion(a->box, f->box);
+            a->height = 1 + ((b->height > g->height)? b->height : g->height);
+            c->height = 1 + ((a->height > f->height)? a->height : f->height);
+        }
+        else
+        {
+            c->child2 = iG;
+            a->child2 = iF;
+            f->parent = iA;
+            a->box = BoxUnion(b->box, f->box);
+            c->box = BoxUnion(a->box, g->box);
+            a->height = 1 + ((b->height > f->height)? b->height : f->height);
+            c->height = 1 + ((a->height > g->height)? a->height : g->height);
+        }
+
+        return iC;
+    }
+
+    // Rotate B up
+    if (balance < -1)
+    {
+        int iD = b->child1;
+        int iE = b->child2;
+        AabbTreeNode *d = &nodes[iD];
+        AabbTreeNode *e = &nodes[iE];
+
+        b->child1 = iA;
+        b->parent = a->parent;
+        a->parent = iB;
+
+        if (b->parent != AABB_TREE_NULL)
+        {
+            if (nodes[b->parent].child1 == iA) nodes[b->parent].child1 = iB;
+            else nodes[b->parent].child2 = iB;
+        }
+        else tree->root = iB;
+
+        if (d->height > e->height)
+        {
+            b->child2 = iD;
+            a->child1 = iE;
+            e->parent = iA;
+            a->box = BoxUnion(c->box, e->box);
+            b->box = BoxUnion(a->box, d->box);
+            a->height = 1 + ((c->height > e->height)? c->height : e->height);
+            b->height = 1 + ((a->height > d->height)? a->height : d->height);
+        }
+        else
+        {
+            b->child2 = iE;
+            a->child1 = iD;
+            d->parent = iA;
+            a->box = BoxUnion(c->box, d->box);
+            b->box = BoxUnion(a->box, e->box);
+            a->height = 1 + ((c->height > d->height)? c->height : d->height);
+            b->height = 1 + ((a->height > e->height)? a->height : e->height);
+        }
+
+        return iB;
+    }
+
+    return iA;
+}
+
+// Walks from index up to the root refitting boxes and heights
+static void Refit(AabbTree *tree, int index)
+{
+    while (index != AABB_TREE_NULL)
+    {
+        index = Balance(tree, index);
+
+        AabbTreeNode *node = &tree->nodes[index];
+        AabbTreeNode *child1 = &tree->nodes[node->child1];
+        AabbTreeNode *child2 = &tree->nodes[node->child2];
+
+        node->height = 1 + ((child1->height > child2->height)? child1->height : child2->height);
+        node->box = BoxUnion(child1->box, child2->box);
+
+        index = node->parent;
+    }
+}
+
+// Surface area heuristic descent, picks the sibling that grows the tree perimeter the least
+static void InsertLeaf(AabbTree *tree, int leaf)
+{
+    AabbTreeNode *nodes = tree->nodes;
+
+    if (tree->root == AABB_TREE_NULL)
+    {
+        tree->root = leaf;
+        nodes[leaf].parent = AABB_TREE_NULL;
+        return;
+    }
+
+    Rectangle leafBox = nodes[leaf].box;
+    int index = tree->root;
+
+    while (nodes[index].height > 0)
+    {
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+
+        float area = BoxPerimeter(nodes[index].box);
+        float combinedArea = BoxPerimeter(BoxUnion(nodes[index].box, leafBox));
+
+        // Cost of creating a new parent for this node and the new leaf
+        float cost = 2.0f*combinedArea;
+        // Minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f*(combinedArea - area);
+
+        float cost1 = BoxPerimeter(BoxUnion(leafBox, nodes[child1].box)) + inheritanceCost;
+        if (nodes[child1].height > 0) cost1 -= BoxPerimeter(nodes[child1].box);
+
+        float cost2 = BoxPerimeter(BoxUnion(leafBox, nodes[child2].box)) + inheritanceCost;
+        if (nodes[child2].height > 0) cost2 -= BoxPerimeter(nodes[child2].box);
+
+        if ((cost < cost1) && (cost < cost2)) break;
+
+        index = (cost1 < cost2)? child1 : child2;
+    }
+
+    int sibling = index;
+    int oldParent = nodes[sibling].parent;
+    int newParent = AllocateNode(tree);
+    nodes = tree->nodes; // Pool may have grown
+
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = BoxUnion(leafBox, nodes[sibling].box);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent != AABB_TREE_NULL)
+    {
+        if (nodes[oldParent].child1 == sibling) nodes[oldParent].child1 = newParent;
+        else nodes[oldParent].child2 = newParent;
+    }
+    else tree->root = newParent;
+
+    Refit(tree, nodes[leaf].parent);
+}
+
+static void RemoveLeaf(AabbTree *tree, int leaf)
+{
+    AabbTreeNode *nodes = tree->nodes;
+
+    if (leaf == tree->root)
+    {
+        tree->root = AABB_TREE_NULL;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = (nodes[parent].child1 == leaf)? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent != AABB_TREE_NULL)
+    {
+        if (nodes[grandParent].child1 == parent) nodes[grandParent].child1 = sibling;
+        else nodes[grandParent].child2 = sibling;
+
+        nodes[sibling].parent = grandParent;
+        FreeNode(tree, parent);
+        Refit(tree, grandParent);
+    }
+    else
+    {
+        tree->root = sibling;
+        nodes[sibling].parent = AABB_TREE_NULL;
+        FreeNode(tree, parent);
+    }
+}
+
+//----------------------------------------------------------------------------------
+// Public API
+//----------------------------------------------------------------------------------
+void InitAabbTree(AabbTree *tree, float margin)
+{
+    tree->nodes = NULL;
+    tree->capacity = 0;
+    tree->count = 0;
+    tree->root = AABB_TREE_NULL;
+    tree->freeList = AABB_TREE_NULL;
+    tree->margin = margin;
+}
+
+void UnloadAabbTree(AabbTree *tree)
+{
+    free(tree->nodes);
+    InitAabbTree(tree, tree->margin);
+}
+
+// Removes every proxy, the node storage is kept for the next ones
+void ClearAabbTree(AabbTree *tree)
+{
+    for (int i = 0; i < tree->capacity; i++)
+    {
+        tree->nodes[i].parent = (i < tree->capacity - 1)? i + 1 : AABB_TREE_NULL;
+        tree->nodes[i].height = -1;
+    }
+
+    tree->count = 0;
+    tree->root = AABB_TREE_NULL;
+    tree->freeList = (tree->capacity > 0)? 0 : AABB_TREE_NULL;
+}
+
+int AabbTreeCreateProxy(AabbTree *tree, Rectangle box, int userData)
+{
+    int proxyId = AllocateNode(tree);
+    AabbTreeNode *node = &tree->nodes[proxyId];
+
+    node->box = (Rectangle){box.x - tree->margin, box.y - tree->margin,
+                            box.width + 2.0f*tree->margin, box.height + 2.0f*tree->margin};
+    node->userData = userData;
+    node->height = 0;
+
+    InsertLeaf(tree, proxyId);
+
+    return proxyId;
+}
+
+bool AabbTreeMoveProxy(AabbTree *tree, int proxyId, Rectangle box, Vector2 displacement)
+{
+    if (BoxContains(tree->nodes[proxyId].box, box)) return false;
+
+    RemoveLeaf(tree, proxyId);
+
+    // Fatten by the margin and stretch towards the movement so steady movers stay inside longer
+    Rectangle fat = {box.x - tree->margin, box.y - tree->margin,
+                     box.width + 2.0f*tree->margin, box.height + 2.0f*tree->margin};
+    float dx = AABB_TREE_DISPLACEMENT_MULTIPLIER*displacement.x;
+    float dy = AABB_TREE_DISPLACEMENT_MULTIPLIER*displacement.y;
+
+    if (dx < 0.0f) fat.x += dx;
+    fat.width += fabsf(dx);
+    if (dy < 0.0f) fat.y += dy;
+    fat.height += fabsf(dy);
+
+    tree->nodes[proxyId].box = fat;
+    InsertLeaf(tree, proxyId);
+
+    return true;
+}
+
+// Nodes still to visit, on the call stack until a degenerate tree needs more and they move to the heap
+typedef struct TraversalStack
+{
+    int *items;
+    int top;
+    int capacity;
+    int local[AABB_TREE_STACK_SIZE];
+} TraversalStack;
+
+static void InitTraversalStack(TraversalStack *stack)
+{
+    stack->items = stack->local;
+    stack->top = 0;
+    stack->capacity = AABB_TREE_STACK_SIZE;
+}
+
+static void PushTraversal(TraversalStack *stack, int nodeId)
+{
+    if (stack->top == stack->capacity)
+    {
+        int *items = (int *)malloc(2*stack->capacity*sizeof(int));
+
+        memcpy(items, stack->items, stack->top*sizeof(int));
+        if (stack->items != stack->local) free(stack->items);
+        stack->items = items;
+        stack->capacity *= 2;
+    }
+
+    stack->items[stack->top++] = nodeId;
+}
+
+static void UnloadTraversalStack(TraversalStack *stack)
+{
+    if (stack->items != stack->local) free(stack->items);
+}
+
+// NOTE: Traversal uses a stack local to the call, so queries on a shared tree are thread safe
+void AabbTreeQuery(const AabbTree *tree, Rectangle box, AabbTreeQueryCallback callback, void *context)
+{
+    TraversalStack stack;
+
+    InitTraversalStack(&stack);
+    if (tree->root != AABB_TREE_NULL) PushTraversal(&stack, tree->root);
+
+    while (stack.top > 0)
+    {
+        const AabbTreeNode *node = &tree->nodes[stack.items[--stack.top]];
+
+        if (!BoxesOverlap(node->box, box)) continue;
+
+        if (node->height == 0)
+        {
+            if (!callback(node->userData, context)) break;
+        }
+        else
+        {
+            PushTraversal(&stack, node->child1);
+            PushTraversal(&stack, node->child2);
+        }
+    }
+
+    UnloadTraversalStack(&stack);
+}
+
+void AabbTreeQuerySegment(const AabbTree *tree, Vector2 start, Vector2 end, AabbTreeSegmentCallback callback, void *context)
+{
+    TraversalStack stack;
+    float maxFraction = 1.0f;
+
+    InitTraversalStack(&stack);
+    if (tree->root != AABB_TREE_NULL) PushTraversal(&stack, tree->root);
+
+    while (stack.top > 0)
+    {
+        const AabbTreeNode *node = &tree->nodes[stack.items[--stack.top]];
+
+        if (!SegmentBoxFraction(start, end, node->box, maxFraction, NULL)) continue;
+
+        if (node->height == 0)
+        {
+            float fraction = callback(start, end, maxFraction, node->userData, context);
+
+            if (fraction == 0.0f) break;
+            if ((fraction > 0.0f) && (fraction < maxFraction)) maxFraction = fraction;
+        }
+        else
+        {
+            PushTraversal(&stack, node->child1);
+            PushTraversal(&stack, node->child2);
+        }
+    }
+
+    UnloadTraversalStack(&stack);
+}
@@ -0,0 +1,53 @@
+#ifndef aabb_tree // guardas de cabeçalho, impedem inclusões cíclicas
+#define aabb_tree
+
+#include "raylib.h"
+
+#define AABB_TREE_NULL -1
+#define AABB_TREE_STACK_SIZE 256        // Traversal stack kept on the call stack, deeper trees move it to the heap
+#define AABB_TREE_DISPLACEMENT_MULTIPLIER 4.0f
+
+typedef struct AabbTreeNode
+{
+    Rectangle box;      // Fat box for leaves, union of the children for internal nodes
+    int userData;
+    int parent;         // Next free node when the node is in the free list
+    int child1;
+    int child2;
+    int height;         // Leaf = 0, free node = -1
+} AabbTreeNode;
+
+// Dynamic bounding volume tree, leaves hold boxes fattened by margin so small
+// movements do not touch the tree structure
+typedef struct AabbTree
+{
+    AabbTreeNode *nodes;
+    int capacity;
+    int count;
+    int root;
+    int freeList;
+    float margin;
+} AabbTree;
+
+// Return false to stop the query
+typedef bool (*AabbTreeQueryCallback)(int userData, void *context);
+// Return the new max fraction of the segment to keep searching, 0 stops the query
+typedef float (*AabbTreeSegmentCallback)(Vector2 start, Vector2 end, float maxFraction, int userData, void *context);
+
+void InitAabbTree(AabbTree *tree, float margin);
+void UnloadAabbTree(AabbTree *tree);
+void ClearAabbTree(AabbTree *tree);
+
+int AabbTreeCreateProxy(AabbTree *tree, Rectangle box, int userData);
+// Returns true when the proxy left its fat box and was reinserted
+bool AabbTreeMoveProxy(AabbTree *tree, int proxyId, Rectangle box, Vector2 displacement);
+
+void AabbTreeQuery(const AabbTree *tree, Rectangle box, AabbTreeQueryCallback callback, void *context);
+void AabbTreeQuerySegment(const AabbTree *tree, Vector2 start, Vector2 end, AabbTreeSegmentCallback callback, void *context);
+
+bool BoxesOverlap(Rectangle a, Rectangle b);
+bool BoxContains(Rectangle outer, Rectangle inner);
+Rectangle BoxUnion(Rectangle a, Rectangle b);
+bool SegmentBoxFraction(Vector2 start, Vector2 end, Rectangle box, float maxFraction, float *fraction);
+
+#endif
@@ -0,0 +1,110 @@
+#include "raylib.h"
+#include "raymath.h"
+
+#include "beam_tracer.h"
+#include "shapes_helpers.h"
+
+#include <stdlib.h>
+
+void InitBeamPath(BeamPath *path, int maxBounces)
+{
+    path->capacity = maxBounces + 2;
+    path->points = (Vector2 *)malloc(path->capacity*sizeof(Vector2));
+    path->qtdPoints = 0;
+    path->goal = ENTITY_NONE;
+    path->entity = ENTITY_NONE;
+}
+
+void UnloadBeamPath(BeamPath *path)
+{
+    free(path->points);
+    path->points = NULL;
+    path->qtdPoints = 0;
+    path->capacity = 0;
+}
+
+// Closest unset goal of the beam color crossed before maxFraction, -1 if none
+static int FindBeamGoal(const Level *map, unsigned int goalsSet, Vector2 start, Vector2 end, Color color, float maxFraction, float *fraction)
+{
+    const EntityStore *store = &map->entities;
+    int result = ENTITY_NONE;
+
+    for (int i = 0; i < CountComponents(store, COMPONENT_GOAL); i++)
+    {
+        int entity = GetComponentOwner(store, COMPONENT_GOAL, i);
+        float t = 0.0f;
+
+        if ((goalsSet & (1u << i)) || !ColorIsEqual(*GetEntityColor(store, entity), color)) continue;
+
+        if (SegmentBoxFraction(start, end, *GetEntityRect(store, entity), maxFraction, &t))
+        {
+            maxFraction = t;
+            *fraction = t;
+            result = entity;
+        }
+    }
+
+    return result;
+}
+
+// Every bounce reuses the path buffer and a stack query, tracing does not allocate
+int TraceBeam(BeamPath *path, const Level *map, Vector2 origin, Vector2 direction, float length, Color color, unsigned int goalsSet)
+{
+    Vector2 start = origin;
+    Vector2 dir = Vector2Normalize(direction);
+    float remaining = length;
+
+    path->qtdPoints = 0;
+    path->goal = ENTITY_NONE;
+    path->entity = ENTITY_NONE;
+
+    if (path->capacity < 2) return 0;
+
+    path->points[path->qtdPoints++] = origin;
+
+    while ((remaining > 0.0f) && (path->qtdPoints < path->capacity))
+    {
+        Vector2 end = Vector2Add(start, Vector2Scale(dir, remaining));
+        LineHit hit = {0};
+        float goalFraction = 1.0f;
+        bool hitItem = GetLineLevelClosestHit((Line){start, end}, map, &hit);
+        int goal = FindBeamGoal(map, goalsSet, start, end, color, hitItem? hit.t : 1.0f, &goalFraction);
+
+        if (goal != ENTITY_NONE)
+        {
+            path->points[path->qtdPoints++] = Vector2Lerp(start, end, goalFraction);
+            path->goal = goal;
+            break;
+        }
+
+        if (!hitItem)
+        {
+            path->points[path->qtdPoints++] = end;
+            break;
+        }
+
+        path->points[path->qtdPoints++] = hit.point;
+        remaining -= remaining*hit.t;
+
+        if (!GetEntityCollider(&map->entities, hit.entity)->mirror)
+        {
+            path->entity = hit.entity;
+            break;
+        }
+
+        dir = Vector2Reflect(dir, hit.normal);
+        start = Vector2Add(hit.point, Vector2Scale(hit.normal, BEAM_SKIN));
+    }
+
+    return path->qtdPoints;
+}
+
+void DrawBeamPath(const BeamPath *path, float thick, Color color)
+{
+    for (int i = 0; i < path->qtdPoints - 1; i++)
+    {
+        DrawLineEx(path->points[i], path->points[i + 1], thick, color);
+    }
+
+    if (path->goal != ENTITY_NONE) DrawCircleV(path->points[path->qtdPoints - 1], thick*2.0f, color);
+}
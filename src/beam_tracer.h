@@ -0,0 +1,29 @@
+#ifndef beam_tracer // guardas de cabeçalho, impedem inclusões cíclicas
+#define beam_tracer
+
+#include "raylib.h"
+
+#include "level.h"
+
+#define BEAM_MAX_BOUNCES 16
+#define BEAM_LENGTH 2000.0f
+#define BEAM_SKIN 0.01f // Distance a reflected beam restarts from the mirror, keeps it from hitting the same side again
+
+// Polyline followed by a beam, from the origin through every bounce to where it stops
+typedef struct BeamPath
+{
+    Vector2 *points;
+    int qtdPoints;
+    int capacity;   // maxBounces + 2
+    int goal;       // Goal entity the beam ended on, -1 if none
+    int entity;     // Collider that stopped the beam, -1 when it ran out of length or bounces
+} BeamPath;
+
+void InitBeamPath(BeamPath *path, int maxBounces);
+void UnloadBeamPath(BeamPath *path);
+// Reflects off mirror colliders until it hits an unset goal of its color, another collider, or runs out of length
+// or bounces. goalsSet has a bit per goal in goal component order, the beam passes through the set ones
+int TraceBeam(BeamPath *path, const Level *map, Vector2 origin, Vector2 direction, float length, Color color, unsigned int goalsSet);
+void DrawBeamPath(const BeamPath *path, float thick, Color color);
+
+#endif
@@ -0,0 +1,140 @@
+#include "raylib.h"
+
+#include "entity_store.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const int componentSizes[COMPONENT_COUNT] = {
+    sizeof(Rectangle),
+    sizeof(Collider),
+    sizeof(Color),
+    sizeof(Mover),
+    sizeof(Trigger),
+    sizeof(GoalState),
+    sizeof(SpawnerState),
+};
+
+void UnloadEntityStore(EntityStore *store)
+{
+    for (int type = 0; type < COMPONENT_COUNT; type++)
+    {
+        free(store->pools[type].data);
+        free(store->pools[type].owners);
+        free(store->pools[type].sparse);
+    }
+
+    free(store->masks);
+    memset(store, 0, sizeof(EntityStore));
+}
+
+static void GrowEntities(EntityStore *store)
+{
+    int capacity = (store->capacity == 0)? 16 : store->capacity*2;
+
+    store->masks = (unsigned int *)realloc(store->masks, capacity*sizeof(unsigned int));
+
+    for (int type = 0; type < COMPONENT_COUNT; type++)
+    {
+        ComponentPool *pool = &store->pools[type];
+
+        pool->sparse = (int *)realloc(pool->sparse, capacity*sizeof(int));
+        for (int i = store->capacity; i < capacity; i++) pool->sparse[i] = -1;
+    }
+
+    store->capacity = capacity;
+}
+
+int CreateEntity(EntityStore *store)
+{
+    if (store->qtdEntities == store->capacity) GrowEntities(store);
+
+    int id = store->qtdEntities++;
+    store->masks[id] = 0;
+
+    return id;
+}
+
+void *AddComponent(EntityStore *store, int entity, ComponentType type)
+{
+    ComponentPool *pool = &store->pools[type];
+    int size = componentSizes[type];
+
+    if (pool->sparse[entity] != -1) return pool->data + pool->sparse[entity]*size;
+
+    if (pool->count == pool->capacity)
+    {
+        pool->capacity = (pool->capacity == 0)? 16 : pool->capacity*2;
+        pool->data = (unsigned char *)realloc(pool->data, pool->capacity*size);
+        pool->owners = (int *)realloc(pool->owners, pool->capacity*sizeof(int));
+    }
+
+    int index = pool->count++;
+    pool->owners[index] = entity;
+    pool->sparse[entity] = index;
+    store->masks[entity] |= COMPONENT_BIT(type);
+    memset(pool->data + index*size, 0, size);
+
+    return pool->data + index*size;
+}
+
+void *GetComponent(const EntityStore *store, int entity, ComponentType type)
+{
+    const ComponentPool *pool = &store->pools[type];
+
+    if ((entity < 0) || (entity >= store->qtdEntities) || (pool->sparse[entity] == -1)) return NULL;
+
+    return pool->data + pool->sparse[entity]*componentSizes[type];
+}
+
+int CountComponents(const EntityStore *store, ComponentType type)
+{
+    return store->pools[type].count;
+}
+
+// Components in the order they were added
+void *GetComponentArray(const EntityStore *store, ComponentType type)
+{
+    return store->pools[type].data;
+}
+
+int GetComponentOwner(const EntityStore *store, ComponentType type, int index)
+{
+    return store->pools[type].owners[index];
+}
+
+EntityQuery QueryEntities(const EntityStore *store, unsigned int with, unsigned int without)
+{
+    EntityQuery query = {store, with, without, -1, 0, ENTITY_NONE};
+
+    for (int type = 0; type < COMPONENT_COUNT; type++)
+    {
+        if ((with & COMPONENT_BIT(type)) &&
+            ((query.driver == -1) || (store->pools[type].count < store->pools[query.driver].count))) query.driver = type;
+    }
+
+    return query;
+}
+
+bool NextEntity(EntityQuery *query)
+{
+    if (query->driver == -1) return false;
+
+    const ComponentPool *pool = &query->store->pools[query->driver];
+
+    while (query->next < pool->count)
+    {
+        int entity = pool->owners[query->next++];
+        unsigned int mask = query->store->masks[entity];
+
+        if (((mask & query->with) == query->with) && !(mask & query->without))
+        {
+            query->entity = entity;
+            return true;
+        }
+    }
+
+    query->entity = ENTITY_NONE;
+
+    return false;
+}
@@ -0,0 +1,114 @@
+#ifndef entity_store // guardas de cabeçalho, impedem inclusões cíclicas
+#define entity_store
+
+#include "raylib.h"
+
+#define ENTITY_NONE -1
+
+typedef enum ComponentType
+{
+    COMPONENT_TRANSFORM = 0,    // Rectangle
+    COMPONENT_COLLIDER,         // Collider, blocks the player, strings and beams
+    COMPONENT_RENDERABLE,       // Color
+    COMPONENT_MOVER,            // Mover
+    COMPONENT_TRIGGER,          // Trigger, the player interacts with it by standing on it
+    COMPONENT_GOAL,             // GoalState
+    COMPONENT_SPAWNER,          // SpawnerState
+    COMPONENT_COUNT
+} ComponentType;
+
+#define COMPONENT_BIT(type) (1u << (type))
+
+typedef struct Collider
+{
+    int proxy;      // Leaf in the level broadphase tree
+    bool mirror;    // Reflects laser beams instead of stopping them
+} Collider;
+
+// Back and forth movement of the transform, between origin and origin + offset
+typedef struct Mover
+{
+    Vector2 offset;
+    float period;       // Seconds for a full round trip
+    float time;
+    Vector2 origin;     // Rect position at the start of the path
+    Vector2 velocity;   // Movement on the last tick in units per second
+    Vector2 displacement; // Movement on the last tick
+} Mover;
+
+typedef struct Trigger
+{
+    bool playerInside;
+} Trigger;
+
+// Which goals are set and which spawners are active is kept in the GameState bit masks,
+// the components only hold what the level was built with
+typedef struct GoalState
+{
+    int line;           // String that sets it, 1 red, 2 green, 3 blue, 0 when none has its color
+} GoalState;
+
+typedef struct SpawnerState
+{
+    int line;           // String it starts, 0 when none has its color
+    bool laser;         // Fires a beam of its color while activated instead of starting a string
+    Vector2 direction;  // Beam direction of a laser spawner
+} SpawnerState;
+
+// Dense array of one component type, components are never removed so they stay in the order
+// they were added, goal and spawner flags are indexed by that order
+typedef struct ComponentPool
+{
+    int count;
+    int capacity;
+    unsigned char *data;
+    int *owners;    // Entity of every component, same order as data
+    int *sparse;    // Entity id -> index in data, -1 when the entity lacks the component
+} ComponentPool;
+
+// A zeroed store is empty and ready to use
+typedef struct EntityStore
+{
+    int qtdEntities;
+    int capacity;
+    unsigned int *masks;    // Components of every entity
+    ComponentPool pools[COMPONENT_COUNT];
+} EntityStore;
+
+// Iterates the entities with every component in with and none in without,
+// walking the smallest of the with pools
+typedef struct EntityQuery
+{
+    const EntityStore *store;
+    unsigned int with;
+    unsigned int without;
+    int driver;
+    int next;
+    int entity;
+} EntityQuery;
+
+void UnloadEntityStore(EntityStore *store);
+
+int CreateEntity(EntityStore *store);
+
+// The new component is zeroed, the pointer is valid until the next component of the same type is added
+void *AddComponent(EntityStore *store, int entity, ComponentType type);
+void *GetComponent(const EntityStore *store, int entity, ComponentType type);
+
+int CountComponents(const EntityStore *store, ComponentType type);
+void *GetComponentArray(const EntityStore *store, ComponentType type);
+int GetComponentOwner(const EntityStore *store, ComponentType type, int index);
+
+EntityQuery QueryEntities(const EntityStore *store, unsigned int with, unsigned int without);
+bool NextEntity(EntityQuery *query);
+
+// Typed access, NULL when the entity lacks the component
+#define GetEntityRect(store, entity)     ((Rectangle *)GetComponent((store), (entity), COMPONENT_TRANSFORM))
+#define GetEntityCollider(store, entity) ((Collider *)GetComponent((store), (entity), COMPONENT_COLLIDER))
+#define GetEntityColor(store, entity)    ((Color *)GetComponent((store), (entity), COMPONENT_RENDERABLE))
+#define GetEntityMover(store, entity)    ((Mover *)GetComponent((store), (entity), COMPONENT_MOVER))
+#define GetEntityTrigger(store, entity)  ((Trigger *)GetComponent((store), (entity), COMPONENT_TRIGGER))
+#define GetEntityGoal(store, entity)     ((GoalState *)GetComponent((store), (entity), COMPONENT_GOAL))
+#define GetEntitySpawner(store, entity)  ((SpawnerState *)GetComponent((store), (entity), COMPONENT_SPAWNER))
+
+#endif
@@ -0,0 +1,86 @@
+#include "raylib.h"
+
+#include "frame_pacing.h"
+
+#include <math.h>
+
+void InitFramePacer(FramePacer *pacer, FramePacingMode mode)
+{
+    int refreshRate = GetMonitorRefreshRate(GetCurrentMonitor());
+    double now = GetTime();
+
+    *pacer = (FramePacer){0};
+    pacer->mode = mode;
+    pacer->interval = 1.0/((refreshRate > 0)? refreshRate : 60);
+    pacer->lastPresent = now;
+    pacer->deadline = now + pacer->interval;
+    pacer->lastInput = now;
+    pacer->margin = FRAME_PACING_MARGIN;
+    pacer->presentInterval = (float)pacer->interval;
+}
+
+// Waits for the wake up time of the mode and samples input, everything after this
+// until EndPacedFrame counts as frame work
+void BeginPacedFrame(FramePacer *pacer)
+{
+    double wake = pacer->lastInput + pacer->interval;
+
+    if (pacer->mode == FRAME_PACING_LOW_LATENCY)
+    {
+        wake = pacer->deadline - pacer->workEstimate - pacer->margin;
+    }
+
+    // WaitTime sleeps most of the time and only spins the last bit, so waiting here does not burn a core
+    double now = GetTime();
+    if (wake > now) WaitTime(wake - now);
+
+    PollInputEvents();
+    now = GetTime();
+
+    pacer->frameTime = fminf((float)(now - pacer->lastInput), FRAME_PACING_MAX_DELTA);
+    pacer->lastInput = now;
+}
+
+// Presents the frame and updates the estimates from the measured present time
+void EndPacedFrame(FramePacer *pacer)
+{
+    double deadline = pacer->deadline;
+
+    pacer->workEnd = GetTime();
+
+    float work = (float)(pacer->workEnd - pacer->lastInput);
+    pacer->workTimes[pacer->workIndex] = work;
+    pacer->workIndex = (pacer->workIndex + 1)%FRAME_PACING_HISTORY;
+
+    pacer->workEstimate = 0.0f;
+    for (int i = 0; i < FRAME_PACING_HISTORY; i++) pacer->workEstimate = fmaxf(pacer->workEstimate, pacer->workTimes[i]);
+
+    SwapScreenBuffer();
+
+    double present = GetTime();
+
+    // With vsync a late swap waits for the next vblank, half an interval late is already a miss
+    if ((pacer->mode == FRAME_PACING_LOW_LATENCY) && (present > deadline + pacer->interval*0.5))
+    {
+        pacer->missedDeadlines++;
+        pacer->margin = fminf(pacer->margin + 0.0005f, (float)pacer->interval*0.5f);
+    }
+    else pacer->margin = fmaxf(pacer->margin - 0.00001f, FRAME_PACING_MARGIN);
+
+    // The frame reaches the middle of the screen half a scanout after the swap
+    float latency = (float)(present - pacer->lastInput + pacer->interval*0.5);
+    pacer->inputToPhoton += (latency - pacer->inputToPhoton)*0.1f;
+    pacer->presentInterval += ((float)(present - pacer->lastPresent) - pacer->presentInterval)*0.1f;
+    pacer->lastPresent = present;
+
+    // Without vsync the swap returns early and the deadlines keep their own cadence,
+    // with vsync the swap returns on the vblank and the next deadline follows it
+    pacer->deadline = (present < deadline)? deadline + pacer->interval : present + pacer->interval;
+}
+
+void DrawFramePacerStats(const FramePacer *pacer, int posX, int posY)
+{
+    DrawText(TextFormat("%s pacing [F2]", (pacer->mode == FRAME_PACING_LOW_LATENCY)? "Low latency" : "Throughput"), posX, posY, 10, DARKGRAY);
+    DrawText(TextFormat("input to photon %.1f ms", pacer->inputToPhoton*1000.0f), posX, posY + 12, 10, DARKGRAY);
+    DrawText(TextFormat("work %.1f ms, present %.1f ms, missed %i", pacer->workEstimate*1000.0f, pacer->presentInterval*1000.0f, pacer->missedDeadlines), posX, posY + 24, 10, DARKGRAY);
+}
@@ -0,0 +1,42 @@
+#ifndef frame_pacing // guardas de cabeçalho, impedem inclusões cíclicas
+#define frame_pacing
+
+#include "raylib.h"
+
+// Frame pacing on top of raylib custom frame control (SUPPORT_CUSTOM_FRAME_CONTROL),
+// the game loop calls BeginPacedFrame, updates and draws, then EndPacedFrame
+
+#define FRAME_PACING_HISTORY 32          // Frames of work time kept for the work estimate
+#define FRAME_PACING_MARGIN 0.0015f      // Seconds between the predicted end of work and the present deadline
+#define FRAME_PACING_MAX_DELTA 0.1f      // Longest frame time handed to the game, after a stall
+
+typedef enum FramePacingMode
+{
+    FRAME_PACING_THROUGHPUT = 0,    // Like SetTargetFPS, input is polled right after the previous present
+    FRAME_PACING_LOW_LATENCY        // Sleeps until just before the predicted deadline, then polls input
+} FramePacingMode;
+
+typedef struct FramePacer
+{
+    FramePacingMode mode;
+    double interval;        // Refresh interval of the monitor
+    double lastPresent;     // When the last SwapScreenBuffer returned
+    double deadline;        // Predicted present time of the frame in flight
+    double lastInput;       // When input was polled for the frame in flight
+    double workEnd;
+    float workTimes[FRAME_PACING_HISTORY];  // Input poll to swap call of the recent frames
+    int workIndex;
+    float workEstimate;     // Max of workTimes
+    float margin;           // Grows on missed deadlines, decays back to FRAME_PACING_MARGIN
+    float frameTime;        // Seconds between the last two input polls, replaces GetFrameTime()
+    float presentInterval;  // Smoothed time between presents
+    float inputToPhoton;    // Smoothed input poll to mid scanout estimate
+    int missedDeadlines;
+} FramePacer;
+
+void InitFramePacer(FramePacer *pacer, FramePacingMode mode);
+void BeginPacedFrame(FramePacer *pacer);
+void EndPacedFrame(FramePacer *pacer);
+void DrawFramePacerStats(const FramePacer *pacer, int posX, int posY);
+
+#endif
@@ -0,0 +1,223 @@
+#include "raylib.h"
+
+#include "game_state.h"
+#include "player.h"
+#include "shapes_helpers.h"
+#include "beam_tracer.h"
+
+static Vector2 RectCenter(Rectangle rect)
+{
+    return (Vector2){rect.x + rect.width/2.0f, rect.y + rect.height/2.0f};
+}
+
+// Appends to the selected string, false when the new segment is not allowed
+static bool AddAnchor(GameProgress *progress, const Level *map, StringIndex *strings, Vector2 point)
+{
+    int line = progress->selectedColor - 1;
+
+    if ((line < 0) || (progress->qtdAnchors[line] >= GAME_MAX_ANCHORS)) return false;
+
+    int count = progress->qtdAnchors[line];
+
+    if (count > 0)
+    {
+        Vector2 last = progress->anchors[line][count - 1];
+
+        if (CheckLineLevelColision((Line){last, point}, map)) return false;
+
+        if (map->forbidCrossing)
+        {
+            StringSegment candidate = {last, point, line + 1, count - 1};
+
+            // A repeated anchor would leave a zero length segment that touches the one before it
+            if ((last.x == point.x) && (last.y == point.y)) return false;
+
+            if (strings != NULL)
+            {
+                if (CheckStringSegmentCrossing(strings, last, point, line + 1, count - 1)) return false;
+            }
+            else
+            {
+                for (int l = 0; l < GAME_LINES; l++)
+                {
+                    for (int j = 0; j < progress->qtdAnchors[l] - 1; j++)
+                    {
+                        StringSegment placed = {progress->anchors[l][j], progress->anchors[l][j + 1], l + 1, j};
+
+                        if (StringSegmentsCross(&candidate, &placed)) return false;
+                    }
+                }
+            }
+        }
+
+        if (strings != NULL) AddStringSegment(strings, last, point, line + 1, count - 1);
+    }
+
+    progress->anchors[line][count] = point;
+    progress->qtdAnchors[line]++;
+    progress->connected &= ~(1u << line);
+
+    return true;
+}
+
+GameState InitGameState(const Level *map, Vector2 spawn)
+{
+    GameState state = {0};
+
+    state.position = spawn;
+    state.groundItem = ENTITY_NONE;
+    state.progress.qtdGoalsRemaining = CountComponents(&map->entities, COMPONENT_GOAL);
+
+    return state;
+}
+
+Rectangle GetPlayerRect(Vector2 position)
+{
+    return (Rectangle){position.x - PLAYER_SIZE/2.0f, position.y - PLAYER_SIZE, PLAYER_SIZE, PLAYER_SIZE};
+}
+
+int ApplyGameInput(GameProgress *progress, const Level *map, Rectangle playerRect, GameInput input, StringIndex *strings)
+{
+    const EntityStore *store = &map->entities;
+    int qtdSpawners = CountComponents(store, COMPONENT_SPAWNER);
+    int qtdGoals = CountComponents(store, COMPONENT_GOAL);
+    const SpawnerState *spawners = (const SpawnerState *)GetComponentArray(store, COMPONENT_SPAWNER);
+    const GoalState *goals = (const GoalState *)GetComponentArray(store, COMPONENT_GOAL);
+    int goalsRemaining = progress->qtdGoalsRemaining;
+
+    if (input.clear)
+    {
+        progress->selectedColor = 0;
+        for (int i = 0; i < qtdSpawners; i++)
+        {
+            if (!spawners[i].laser) progress->spawnersActive &= ~(1u << i);
+        }
+    }
+
+    if (input.interact)
+    {
+        for (int i = 0; i < qtdSpawners; i++)
+        {
+            int entity = GetComponentOwner(store, COMPONENT_SPAWNER, i);
+            Rectangle rect = *GetEntityRect(store, entity);
+
+            if (!CheckCollisionRecs(playerRect, rect)) continue;
+
+            if (spawners[i].laser)
+            {
+                progress->spawnersActive ^= (1u << i);
+                break;
+            }
+
+            if (spawners[i].line != 0) progress->selectedColor = spawners[i].line;
+
+            if ((progress->selectedColor != 0) && !(progress->spawnersActive & (1u << i)))
+            {
+                progress->spawnersActive |= (1u << i);
+                AddAnchor(progress, map, strings, RectCenter(rect));
+                break;
+            }
+        }
+    }
+
+    if (input.create)
+    {
+        Vector2 playerCenter = RectCenter(playerRect);
+        bool setGoal = false;
+
+        for (int i = 0; i < qtdGoals; i++)
+        {
+            int entity = GetComponentOwner(store, COMPONENT_GOAL, i);
+            Rectangle rect = *GetEntityRect(store, entity);
+            int line = progress->selectedColor - 1;
+
+            if ((line < 0) || (goals[i].line != progress->selectedColor)) continue;
+            if (progress->qtdAnchors[line] == 0) continue;
+            if (CheckLineLevelColision((Line){progress->anchors[line][progress->qtdAnchors[line] - 1], playerCenter}, map)) continue;
+
+            if (!(progress->goalsSet & (1u << i)) && CheckCollisionRecs(playerRect, rect) && AddAnchor(progress, map, strings, RectCenter(rect)))
+            {
+                progress->goalsSet |= (1u << i);
+                progress->qtdGoalsRemaining--;
+                progress->connected |= (1u << line);
+                progress->selectedColor = 0;
+                setGoal = true;
+            }
+        }
+
+        if (!setGoal) AddAnchor(progress, map, strings, playerCenter);
+    }
+
+    // Lasers trace into a stack buffer, so stepping many states in parallel does not allocate
+    Vector2 beamPoints[BEAM_MAX_BOUNCES + 2];
+    BeamPath beam = {beamPoints, 0, BEAM_MAX_BOUNCES + 2, ENTITY_NONE, ENTITY_NONE};
+
+    for (int i = 0; i < qtdSpawners; i++)
+    {
+        if (!spawners[i].laser || !(progress->spawnersActive & (1u << i))) continue;
+
+        int entity = GetComponentOwner(store, COMPONENT_SPAWNER, i);
+
+        TraceBeam(&beam, map, RectCenter(*GetEntityRect(store, entity)), spawners[i].direction, BEAM_LENGTH, *GetEntityColor(store, entity), progress->goalsSet);
+
+        if (beam.goal != ENTITY_NONE)
+        {
+            for (int g = 0; g < qtdGoals; g++)
+            {
+                if (GetComponentOwner(store, COMPONENT_GOAL, g) == beam.goal)
+                {
+                    progress->goalsSet |= (1u << g);
+                    progress->qtdGoalsRemaining--;
+                }
+            }
+        }
+    }
+
+    return goalsRemaining - progress->qtdGoalsRemaining;
+}
+
+void StepPlayerBody(const Level *map, Vector2 *position, float *speed, bool *canJump, int *groundItem, int move, bool jump, float delta)
+{
+    if (move < 0) position->x -= PLAYER_HOR_SPD*delta;
+    if (move > 0) position->x += PLAYER_HOR_SPD*delta;
+
+    if (jump && *canJump)
+    {
+        *speed = -PLAYER_JUMP_SPD;
+        *canJump = false;
+    }
+
+    // Moving platforms carry the player along, so the top surface is still under the feet below
+    const Mover *groundMover = GetEntityMover(&map->entities, *groundItem);
+    if (groundMover != NULL)
+    {
+        position->x += groundMover->velocity.x*delta;
+        position->y += groundMover->velocity.y*delta;
+    }
+
+    int ground = FindLevelGround(map, *position, *speed*delta);
+    *groundItem = ground;
+
+    if (ground != ENTITY_NONE)
+    {
+        *speed = 0.0f;
+        position->y = GetEntityRect(&map->entities, ground)->y;
+        *canJump = true;
+    }
+    else
+    {
+        position->y += *speed*delta;
+        *speed += G*delta;
+        *canJump = false;
+    }
+}
+
+int StepGameState(GameState *state, const Level *map, GameInput input, float delta)
+{
+    int goals = ApplyGameInput(&state->progress, map, GetPlayerRect(state->position), input, NULL);
+
+    StepPlayerBody(map, &state->position, &state->speed, &state->canJump, &state->groundItem, input.move, input.jump, delta);
+    state->steps++;
+
+    return goals;
+}
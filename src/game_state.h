@@ -0,0 +1,56 @@
+#ifndef game_state // guardas de cabeçalho, impedem inclusões cíclicas
+#define game_state
+
+#include "raylib.h"
+
+#include "level.h"
+#include "string_crossing.h"
+
+#define GAME_LINES 3
+#define GAME_MAX_ANCHORS 5      // Anchors per string, the interactive game keeps its strings in a GameState too
+
+// What the keys do in the interactive game, one action set per step
+typedef struct GameInput
+{
+    signed char move;   // -1 left, 0 stay, 1 right
+    bool jump;
+    bool interact;      // E, take a string from a spawner or toggle a laser
+    bool create;        // C, anchor the string on a goal or where the player is
+    bool clear;         // Q, drop the selected string
+} GameInput;
+
+// Everything besides the player body that changes while a level is played, plain data
+typedef struct GameProgress
+{
+    int selectedColor;                                  // 1 red, 2 green, 3 blue, 0 none
+    Vector2 anchors[GAME_LINES][GAME_MAX_ANCHORS];
+    int qtdAnchors[GAME_LINES];
+    unsigned int connected;         // Bit per line, the last anchor sits on a goal it set
+    unsigned int goalsSet;          // Bit per goal, in goal component order
+    unsigned int spawnersActive;    // Bit per spawner, in spawner component order
+    int qtdGoalsRemaining;
+} GameProgress;
+
+// One instance of the game on a level, the level itself is shared and read only,
+// so states can be copied, stored and stepped on any thread
+typedef struct GameState
+{
+    Vector2 position;   // Feet of the player
+    float speed;
+    bool canJump;
+    int groundItem;
+    int steps;
+    GameProgress progress;
+} GameState;
+
+GameState InitGameState(const Level *map, Vector2 spawn);
+// Returns how many goals the step set
+int StepGameState(GameState *state, const Level *map, GameInput input, float delta);
+// The E, C and Q rules and the lasers. strings indexes the placed segments for the crossing rule and is
+// kept up to date, with NULL every placed segment is tested, which is cheap at GAME_MAX_ANCHORS
+int ApplyGameInput(GameProgress *progress, const Level *map, Rectangle playerRect, GameInput input, StringIndex *strings);
+// Walking, jumping, gravity and landing, shared with the interactive player
+void StepPlayerBody(const Level *map, Vector2 *position, float *speed, bool *canJump, int *groundItem, int move, bool jump, float delta);
+Rectangle GetPlayerRect(Vector2 position);
+
+#endif
@@ -0,0 +1,253 @@
+#include "raylib.h"
+
+#include "level.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+//----------------------------------------------------------------------------------
+// Level building
+//----------------------------------------------------------------------------------
+// String of the color, 1 red, 2 green, 3 blue, 0 for any other color
+static int GetColorLine(Color color)
+{
+  if (ColorIsEqual(color, RED)) return 1;
+  if (ColorIsEqual(color, GREEN)) return 2;
+  if (ColorIsEqual(color, BLUE)) return 3;
+
+  return 0;
+}
+
+// Background when not blocking, platform otherwise
+int AddLevelItem(Level *map, Rectangle rect, bool blocking, Color color)
+{
+  int entity = CreateEntity(&map->entities);
+
+  *(Rectangle *)AddComponent(&map->entities, entity, COMPONENT_TRANSFORM) = rect;
+  *(Color *)AddComponent(&map->entities, entity, COMPONENT_RENDERABLE) = color;
+  if (blocking) AddComponent(&map->entities, entity, COMPONENT_COLLIDER);
+
+  return entity;
+}
+
+int AddLevelMirror(Level *map, Rectangle rect, Color color)
+{
+  int entity = AddLevelItem(map, rect, true, color);
+
+  GetEntityCollider(&map->entities, entity)->mirror = true;
+
+  return entity;
+}
+
+// A zero period keeps the item static
+void SetLevelItemPath(Level *map, int entity, Vector2 offset, float period)
+{
+  Mover *mover = (Mover *)AddComponent(&map->entities, entity, COMPONENT_MOVER);
+
+  mover->offset = offset;
+  mover->period = period;
+}
+
+int AddLevelGoal(Level *map, Rectangle rect, Color color)
+{
+  if (CountComponents(&map->entities, COMPONENT_GOAL) >= LEVEL_MAX_FLAGS)
+  {
+    TraceLog(LOG_WARNING, "LEVEL %i: More than %i goals, the goal is left out", map->id, LEVEL_MAX_FLAGS);
+    return ENTITY_NONE;
+  }
+
+  int entity = AddLevelItem(map, rect, false, color);
+
+  AddComponent(&map->entities, entity, COMPONENT_TRIGGER);
+  ((GoalState *)AddComponent(&map->entities, entity, COMPONENT_GOAL))->line = GetColorLine(color);
+
+  return entity;
+}
+
+int AddLevelSpawner(Level *map, Rectangle rect, Color color)
+{
+  if (CountComponents(&map->entities, COMPONENT_SPAWNER) >= LEVEL_MAX_FLAGS)
+  {
+    TraceLog(LOG_WARNING, "LEVEL %i: More than %i spawners, the spawner is left out", map->id, LEVEL_MAX_FLAGS);
+    return ENTITY_NONE;
+  }
+
+  int entity = AddLevelItem(map, rect, false, color);
+
+  AddComponent(&map->entities, entity, COMPONENT_TRIGGER);
+  ((SpawnerState *)AddComponent(&map->entities, entity, COMPONENT_SPAWNER))->line = GetColorLine(color);
+
+  return entity;
+}
+
+int AddLevelLaser(Level *map, Rectangle rect, Color color, Vector2 direction)
+{
+  int entity = AddLevelSpawner(map, rect, color);
+
+  if (entity == ENTITY_NONE) return ENTITY_NONE;
+
+  SpawnerState *spawner = GetEntitySpawner(&map->entities, entity);
+
+  spawner->laser = true;
+  spawner->direction = direction;
+
+  return entity;
+}
+
+//----------------------------------------------------------------------------------
+// Systems
+//----------------------------------------------------------------------------------
+// Builds the broadphase tree and the level bounds, call once the entities are added
+void InitLevelEnv(Level *map)
+{
+  EntityStore *store = &map->entities;
+  EntityQuery query = QueryEntities(store, COMPONENT_BIT(COMPONENT_TRANSFORM), 0);
+  bool first = true;
+
+  InitAabbTree(&map->envTree, ENV_TREE_MARGIN);
+
+  map->moverRise = 0.0f;
+
+  while (NextEntity(&query))
+  {
+    Rectangle rect = *GetEntityRect(store, query.entity);
+    Mover *mover = GetEntityMover(store, query.entity);
+    Collider *collider = GetEntityCollider(store, query.entity);
+
+    Rectangle sweep = rect;
+    if (mover != NULL)
+    {
+      mover->origin = (Vector2){rect.x, rect.y};
+      mover->velocity = (Vector2){0, 0};
+      mover->displacement = (Vector2){0, 0};
+      if (mover->period > 0.0f) sweep = BoxUnion(sweep, (Rectangle){rect.x + mover->offset.x, rect.y + mover->offset.y, rect.width, rect.height});
+    }
+
+    map->bounds = first? sweep : BoxUnion(map->bounds, sweep);
+    first = false;
+
+    if (collider != NULL) collider->proxy = AabbTreeCreateProxy(&map->envTree, rect, query.entity);
+  }
+}
+
+// Moves the items along their paths, the tree is only restructured when a mover leaves its fat box
+void UpdateLevelEnv(Level *map, float delta)
+{
+  EntityStore *store = &map->entities;
+  EntityQuery query = QueryEntities(store, COMPONENT_BIT(COMPONENT_MOVER) | COMPONENT_BIT(COMPONENT_TRANSFORM), 0);
+
+  map->moverRise = 0.0f;
+
+  while (NextEntity(&query))
+  {
+    Mover *mover = GetEntityMover(store, query.entity);
+    Rectangle *rect = GetEntityRect(store, query.entity);
+    Collider *collider = GetEntityCollider(store, query.entity);
+
+    if (mover->period <= 0.0f) continue;
+
+    mover->time = fmodf(mover->time + delta, mover->period);
+
+    // Eased ping-pong between origin and origin + offset
+    float s = 0.5f - 0.5f * cosf(2.0f * PI * mover->time / mover->period);
+    Vector2 previous = {rect->x, rect->y};
+    rect->x = mover->origin.x + mover->offset.x * s;
+    rect->y = mover->origin.y + mover->offset.y * s;
+
+    Vector2 displacement = {rect->x - previous.x, rect->y - previous.y};
+    mover->velocity = (delta > 0.0f)? (Vector2){displacement.x / delta, displacement.y / delta} : (Vector2){0, 0};
+    mover->displacement = displacement;
+    map->moverRise = fmaxf(map->moverRise, -displacement.y);
+
+    if (collider != NULL) AabbTreeMoveProxy(&map->envTree, collider->proxy, *rect, displacement);
+  }
+}
+
+// Puts every mover back at the start of its path, for a level restart
+void ResetLevelEnv(Level *map)
+{
+  EntityStore *store = &map->entities;
+  EntityQuery query = QueryEntities(store, COMPONENT_BIT(COMPONENT_MOVER) | COMPONENT_BIT(COMPONENT_TRANSFORM), 0);
+
+  map->moverRise = 0.0f;
+
+  while (NextEntity(&query))
+  {
+    Mover *mover = GetEntityMover(store, query.entity);
+    Rectangle *rect = GetEntityRect(store, query.entity);
+    Collider *collider = GetEntityCollider(store, query.entity);
+
+    mover->time = 0.0f;
+    mover->velocity = (Vector2){0, 0};
+    mover->displacement = (Vector2){0, 0};
+    rect->x = mover->origin.x;
+    rect->y = mover->origin.y;
+
+    if (collider != NULL) AabbTreeMoveProxy(&map->envTree, collider->proxy, *rect, mover->displacement);
+  }
+}
+
+// Marks the triggers the player stands on, input and hints read them instead of testing the rects again
+void UpdateLevelTriggers(Level *map, Rectangle playerRect)
+{
+  EntityStore *store = &map->entities;
+  EntityQuery query = QueryEntities(store, COMPONENT_BIT(COMPONENT_TRIGGER) | COMPONENT_BIT(COMPONENT_TRANSFORM), 0);
+
+  while (NextEntity(&query))
+  {
+    GetEntityTrigger(store, query.entity)->playerInside = CheckCollisionRecs(playerRect, *GetEntityRect(store, query.entity));
+  }
+}
+
+void UnloadLevel(Level *map)
+{
+  UnloadAabbTree(&map->envTree);
+  UnloadReachGraph(&map->reach);
+  UnloadLevelSdf(&map->sdf);
+  UnloadEntityStore(&map->entities);
+}
+
+typedef struct GroundQuery
+{
+  const EntityStore *entities;
+  Vector2 position;
+  float fallDistance;
+  int ground;
+  float groundY;
+} GroundQuery;
+
+static bool GroundQueryCallback(int userData, void *context)
+{
+  GroundQuery *query = (GroundQuery *)context;
+  const Rectangle *rect = GetEntityRect(query->entities, userData);
+  const Mover *mover = GetEntityMover(query->entities, userData);
+  Vector2 p = query->position;
+
+  // A mover already took its step this tick, the feet have to be above where its top was before it,
+  // otherwise a platform rising into a falling player passes through the feet without a landing
+  float previousTop = (mover != NULL)? rect->y - mover->displacement.y : rect->y;
+
+  if (rect->x <= p.x && rect->x + rect->width >= p.x && previousTop >= p.y &&
+      rect->y <= p.y + query->fallDistance)
+  {
+    // Keep the highest top surface so fast falls never pick a platform below another one
+    if (query->ground == ENTITY_NONE || rect->y < query->groundY)
+    {
+      query->ground = userData;
+      query->groundY = rect->y;
+    }
+  }
+
+  return true;
+}
+
+// Entity of the collider whose top surface is crossed by falling fallDistance from position, -1 if none
+int FindLevelGround(const Level *map, Vector2 position, float fallDistance)
+{
+  GroundQuery query = {&map->entities, position, fallDistance, ENTITY_NONE, 0.0f};
+  Rectangle probe = {position.x, position.y - map->moverRise, 0.0f, fmaxf(fallDistance, 0.0f) + map->moverRise};
+
+  AabbTreeQuery(&map->envTree, probe, GroundQueryCallback, &query);
+
+  return query.ground;
+}
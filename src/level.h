@@ -1,11 +1,42 @@
 #ifndef level// guardas de cabeçalho, impedem inclusões cíclicas
 #define level
 
-typedef struct EnvItem
+#include "raylib.h"
+
+#include "aabb_tree.h"
+#include "entity_store.h"
+#include "reachability.h"
+#include "level_sdf.h"
+
+#define ENV_TREE_MARGIN 8.0f
+#define LEVEL_MAX_FLAGS 32     // Goals and spawners per level, the game keeps their state in bit masks
+
+typedef struct Level
 {
-  Rectangle rect;
-  int blocking;
-  Color color;
-} EnvItem;
+  int id;
+  EntityStore entities;  // Platforms, goals and spawners of the level
+  AabbTree envTree;      // Broadphase over the colliders, proxies carry the entity id
+  Rectangle bounds;      // Union of every transform over its whole path
+  bool forbidCrossing;   // Strings may not cross each other or themselves
+  ReachGraph reach;      // Jump reachability between the static platforms
+  LevelSdf sdf;          // Distance to the static platforms, for the glow
+  float moverRise;       // Largest upward movement of a mover on the last tick
+} Level;
+
+// Level building, the returned entity ids stay valid for the level lifetime,
+// goals and spawners past LEVEL_MAX_FLAGS are refused with ENTITY_NONE
+int AddLevelItem(Level *map, Rectangle rect, bool blocking, Color color);
+int AddLevelMirror(Level *map, Rectangle rect, Color color);
+void SetLevelItemPath(Level *map, int entity, Vector2 offset, float period);
+int AddLevelGoal(Level *map, Rectangle rect, Color color);
+int AddLevelSpawner(Level *map, Rectangle rect, Color color);
+int AddLevelLaser(Level *map, Rectangle rect, Color color, Vector2 direction);
+
+void InitLevelEnv(Level *map);
+void UpdateLevelEnv(Level *map, float delta);
+void ResetLevelEnv(Level *map);
+void UpdateLevelTriggers(Level *map, Rectangle playerRect);
+void UnloadLevel(Level *map);
+int FindLevelGround(const Level *map, Vector2 position, float fallDistance);
 
-#endif
\ No newline at end of file
+#endif
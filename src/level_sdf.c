@@ -0,0 +1,245 @@
+#include "raylib.h"
+#include "raymath.h"
+
+#include "level_sdf.h"
+#include "level.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(_OPENMP)
+    #include <omp.h>
+#endif
+
+#if defined(PLATFORM_WEB)
+static const char *glowShaderCode =
+    "#version 100\n"
+    "precision mediump float;\n"
+    "varying vec2 fragTexCoord;\n"
+    "varying vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform float range;\n"
+    "uniform float glowWidth;\n"
+    "void main()\n"
+    "{\n"
+    "    float distance = (texture2D(texture0, fragTexCoord).r*255.0 - 128.0)/127.0*range;\n"
+    "    float glow = (distance > 0.0)? 1.0 - smoothstep(0.0, glowWidth, distance) : 0.0;\n"
+    "    gl_FragColor = vec4(fragColor.rgb, fragColor.a*glow*glow);\n"
+    "}\n";
+#else
+static const char *glowShaderCode =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform float range;\n"
+    "uniform float glowWidth;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    float distance = (texture(texture0, fragTexCoord).r*255.0 - 128.0)/127.0*range;\n"
+    "    float glow = (distance > 0.0)? 1.0 - smoothstep(0.0, glowWidth, distance) : 0.0;\n"
+    "    finalColor = vec4(fragColor.rgb, fragColor.a*glow*glow);\n"
+    "}\n";
+#endif
+
+static double GetWallTime(void)
+{
+#if defined(_OPENMP)
+    return omp_get_wtime();
+#else
+    return (double)clock()/CLOCKS_PER_SEC;   // Single threaded, CPU time is close enough
+#endif
+}
+
+// Negative inside, the depth to the closest side
+static float RectSignedDistance(Vector2 point, Rectangle rect)
+{
+    float dx = fmaxf(rect.x - point.x, point.x - (rect.x + rect.width));
+    float dy = fmaxf(rect.y - point.y, point.y - (rect.y + rect.height));
+
+    if ((dx <= 0.0f) && (dy <= 0.0f)) return fmaxf(dx, dy);
+
+    return sqrtf(fmaxf(dx, 0.0f)*fmaxf(dx, 0.0f) + fmaxf(dy, 0.0f)*fmaxf(dy, 0.0f));
+}
+
+static Vector2 GetCellCenter(const LevelSdf *sdf, int x, int y)
+{
+    return (Vector2){sdf->area.x + (x + 0.5f)*SDF_CELL_SIZE, sdf->area.y + (y + 0.5f)*SDF_CELL_SIZE};
+}
+
+static bool IsMovingCollider(const EntityStore *store, int entity)
+{
+    const Mover *mover = GetEntityMover(store, entity);
+
+    return (mover != NULL) && (mover->period > 0.0f);
+}
+
+// Every cell looks at the rects known by the 8 cells step away, the rect ids spread over the
+// grid in log2(size) passes. Reads src and writes dst, so the rows are independent.
+static void JumpFloodPass(const LevelSdf *sdf, const Rectangle *rects, const int *src, int *dst, int step)
+{
+#if defined(_OPENMP)
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int y = 0; y < sdf->height; y++)
+    {
+        for (int x = 0; x < sdf->width; x++)
+        {
+            Vector2 center = GetCellCenter(sdf, x, y);
+            int best = src[y*sdf->width + x];
+            float bestDistance = (best == -1)? INFINITY : RectSignedDistance(center, rects[best]);
+
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    int nx = x + dx*step;
+                    int ny = y + dy*step;
+
+                    if ((nx < 0) || (ny < 0) || (nx >= sdf->width) || (ny >= sdf->height)) continue;
+
+                    int candidate = src[ny*sdf->width + nx];
+                    if ((candidate == -1) || (candidate == best)) continue;
+
+                    float distance = RectSignedDistance(center, rects[candidate]);
+                    if (distance < bestDistance)
+                    {
+                        best = candidate;
+                        bestDistance = distance;
+                    }
+                }
+            }
+
+            dst[y*sdf->width + x] = best;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------
+// Public API
+//----------------------------------------------------------------------------------
+void BakeLevelSdf(Level *map)
+{
+    LevelSdf *sdf = &map->sdf;
+    const EntityStore *store = &map->entities;
+    int qtdColliders = CountComponents(store, COMPONENT_COLLIDER);
+    int qtdRects = 0;
+    double start = GetWallTime();
+
+    sdf->width = (int)ceilf((map->bounds.width + 2.0f*SDF_PADDING)/SDF_CELL_SIZE);
+    sdf->height = (int)ceilf((map->bounds.height + 2.0f*SDF_PADDING)/SDF_CELL_SIZE);
+    sdf->area = (Rectangle){map->bounds.x - SDF_PADDING, map->bounds.y - SDF_PADDING, sdf->width*SDF_CELL_SIZE, sdf->height*SDF_CELL_SIZE};
+    sdf->distances = (float *)malloc(sdf->width*sdf->height*sizeof(float));
+
+    Rectangle *rects = (Rectangle *)malloc((qtdColliders > 0? qtdColliders : 1)*sizeof(Rectangle));
+    int *nearest = (int *)malloc(sdf->width*sdf->height*sizeof(int));
+    int *scratch = (int *)malloc(sdf->width*sdf->height*sizeof(int));
+
+    for (int i = 0; i < sdf->width*sdf->height; i++) nearest[i] = -1;
+
+    // Seeds, every cell a rect overlaps starts out knowing it
+    EntityQuery query = QueryEntities(store, COMPONENT_BIT(COMPONENT_COLLIDER) | COMPONENT_BIT(COMPONENT_TRANSFORM), 0);
+    while (NextEntity(&query))
+    {
+        if (IsMovingCollider(store, query.entity)) continue;
+
+        Rectangle rect = *GetEntityRect(store, query.entity);
+        int x0 = (int)Clamp(floorf((rect.x - sdf->area.x)/SDF_CELL_SIZE), 0.0f, sdf->width - 1.0f);
+        int x1 = (int)Clamp(floorf((rect.x + rect.width - sdf->area.x)/SDF_CELL_SIZE), 0.0f, sdf->width - 1.0f);
+        int y0 = (int)Clamp(floorf((rect.y - sdf->area.y)/SDF_CELL_SIZE), 0.0f, sdf->height - 1.0f);
+        int y1 = (int)Clamp(floorf((rect.y + rect.height - sdf->area.y)/SDF_CELL_SIZE), 0.0f, sdf->height - 1.0f);
+
+        rects[qtdRects] = rect;
+
+        for (int y = y0; y <= y1; y++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                int *cell = &nearest[y*sdf->width + x];
+                Vector2 center = GetCellCenter(sdf, x, y);
+
+                if ((*cell == -1) || (RectSignedDistance(center, rect) < RectSignedDistance(center, rects[*cell]))) *cell = qtdRects;
+            }
+        }
+
+        qtdRects++;
+    }
+
+    int step = 1;
+    while (2*step < ((sdf->width > sdf->height)? sdf->width : sdf->height)) step *= 2;
+
+    // One extra pass of step 1 at the end fixes most of the cells the halving steps got wrong
+    for (; step >= 1; step /= 2)
+    {
+        JumpFloodPass(sdf, rects, nearest, scratch, step);
+        int *swap = nearest;
+        nearest = scratch;
+        scratch = swap;
+    }
+    JumpFloodPass(sdf, rects, nearest, scratch, 1);
+
+    float empty = sdf->area.width + sdf->area.height;   // No static collider in the level
+
+    for (int y = 0; y < sdf->height; y++)
+    {
+        for (int x = 0; x < sdf->width; x++)
+        {
+            int rect = scratch[y*sdf->width + x];
+            sdf->distances[y*sdf->width + x] = (rect == -1)? empty : RectSignedDistance(GetCellCenter(sdf, x, y), rects[rect]);
+        }
+    }
+
+    free(rects);
+    free(nearest);
+    free(scratch);
+
+    sdf->bakeTime = GetWallTime() - start;
+    TraceLog(LOG_INFO, "LEVEL %i: Distance field %ix%i baked in %.2f ms", map->id, sdf->width, sdf->height, sdf->bakeTime*1000.0);
+}
+
+void UploadLevelSdf(LevelSdf *sdf)
+{
+    if (sdf->distances == NULL) return;
+
+    unsigned char *pixels = (unsigned char *)malloc(sdf->width*sdf->height);
+
+    for (int i = 0; i < sdf->width*sdf->height; i++)
+    {
+        pixels[i] = (unsigned char)(128.0f + Clamp(sdf->distances[i]/SDF_TEXTURE_RANGE, -1.0f, 1.0f)*127.0f + 0.5f);
+    }
+
+    Image image = {pixels, sdf->width, sdf->height, 1, PIXELFORMAT_UNCOMPRESSED_GRAYSCALE};
+    sdf->texture = LoadTextureFromImage(image);
+    SetTextureFilter(sdf->texture, TEXTURE_FILTER_BILINEAR);
+
+    free(pixels);
+}
+
+void UnloadLevelSdf(LevelSdf *sdf)
+{
+    if (sdf->texture.id > 0) UnloadTexture(sdf->texture);
+    free(sdf->distances);
+    *sdf = (LevelSdf){0};
+}
+
+Shader LoadLevelGlowShader(void)
+{
+    return LoadShaderFromMemory(NULL, glowShaderCode);
+}
+
+// Soft outline around the static colliders, fading out over width world units
+void DrawLevelGlow(const LevelSdf *sdf, Shader shader, Color color, float width)
+{
+    if (sdf->texture.id == 0) return;
+
+    float range = SDF_TEXTURE_RANGE;
+
+    SetShaderValue(shader, GetShaderLocation(shader, "range"), &range, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader, GetShaderLocation(shader, "glowWidth"), &width, SHADER_UNIFORM_FLOAT);
+
+    BeginShaderMode(shader);
+    DrawTexturePro(sdf->texture, (Rectangle){0, 0, (float)sdf->width, (float)sdf->height}, sdf->area, (Vector2){0, 0}, 0.0f, color);
+    EndShaderMode();
+}
@@ -0,0 +1,33 @@
+#ifndef level_sdf // guardas de cabeçalho, impedem inclusões cíclicas
+#define level_sdf
+
+#include "raylib.h"
+
+#define SDF_CELL_SIZE 4.0f                      // World units per cell
+#define SDF_PADDING 32.0f                       // Grid border around the level bounds
+#define SDF_TEXTURE_RANGE 32.0f                 // Distance mapped to the ends of the texture values
+
+// Distance to the static colliders sampled at the cell centers, baked once per level for the glow.
+// Colliders that move are left out of the field.
+typedef struct LevelSdf
+{
+    Rectangle area;         // World area covered by the grid
+    int width;
+    int height;
+    float *distances;       // [y*width + x], negative inside a collider
+    double bakeTime;        // Seconds
+    Texture2D texture;      // Distances packed in a grayscale texture, id 0 until uploaded
+} LevelSdf;
+
+struct Level; // Defined in level.h, which stores the field
+
+// Bakes on the CPU with jump flooding, call after InitLevelEnv
+void BakeLevelSdf(struct Level *map);
+// Needs the window, the field is only drawn from the texture
+void UploadLevelSdf(LevelSdf *sdf);
+void UnloadLevelSdf(LevelSdf *sdf);
+
+Shader LoadLevelGlowShader(void);
+void DrawLevelGlow(const LevelSdf *sdf, Shader shader, Color color, float width);
+
+#endif
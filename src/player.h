@@ -0,0 +1,20 @@
+#ifndef player_h // guardas de cabeçalho, impedem inclusões cíclicas
+#define player_h
+
+#include "raylib.h"
+
+#include "game_state.h"
+
+#define G 800
+#define PLAYER_JUMP_SPD 400.0f
+#define PLAYER_HOR_SPD 200.0f
+#define PLAYER_SIZE 40.0f
+
+typedef struct Player
+{
+  Rectangle rect;
+  float size;
+  GameState state; // Body, strings and goal and spawner flags, stepped by the same rules as the headless game
+} Player;
+
+#endif
@@ -0,0 +1,225 @@
+#include "raylib.h"
+
+#include "polyline.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static float PointSegmentDistanceSqr(Vector2 point, Vector2 start, Vector2 end)
+{
+  float dx = end.x - start.x;
+  float dy = end.y - start.y;
+  float lengthSqr = dx*dx + dy*dy;
+  float t = (lengthSqr > 0.0f)? ((point.x - start.x)*dx + (point.y - start.y)*dy)/lengthSqr : 0.0f;
+
+  if (t < 0.0f) t = 0.0f;
+  else if (t > 1.0f) t = 1.0f;
+
+  float px = start.x + dx*t - point.x;
+  float py = start.y + dy*t - point.y;
+
+  return px*px + py*py;
+}
+
+// Douglas-Peucker without recursion over the anchors from begin to end, ranges still to split wait on the
+// stack as index pairs. Writes the kept indices in order, both ends included, and returns how many.
+static int SimplifyPolyline(const Vector2 *points, int begin, int end, float tolerance, int *kept, unsigned char *marks, int *stack)
+{
+  int count = end - begin + 1;
+  int top = 0;
+  int qtdKept = 0;
+
+  // marks[i] stands for points[begin + i]
+  memset(marks, 0, count);
+  marks[0] = 1;
+  marks[count - 1] = 1;
+
+  if (count > 2)
+  {
+    stack[top++] = begin;
+    stack[top++] = end;
+  }
+
+  while (top > 0)
+  {
+    int last = stack[--top];
+    int first = stack[--top];
+    int farthest = -1;
+    float maxDistanceSqr = tolerance*tolerance;
+
+    for (int i = first + 1; i < last; i++)
+    {
+      float distanceSqr = PointSegmentDistanceSqr(points[i], points[first], points[last]);
+
+      if (distanceSqr > maxDistanceSqr)
+      {
+        maxDistanceSqr = distanceSqr;
+        farthest = i;
+      }
+    }
+
+    if (farthest == -1) continue;
+
+    marks[farthest - begin] = 1;
+    if (farthest - first > 1)
+    {
+      stack[top++] = first;
+      stack[top++] = farthest;
+    }
+    if (last - farthest > 1)
+    {
+      stack[top++] = farthest;
+      stack[top++] = last;
+    }
+  }
+
+  for (int i = 0; i < count; i++)
+  {
+    if (marks[i]) kept[qtdKept++] = begin + i;
+  }
+
+  return qtdKept;
+}
+
+void InitPolylineLod(PolylineLod *lod)
+{
+  memset(lod, 0, sizeof(PolylineLod));
+  lod->qtdPoints = -1;
+}
+
+void UnloadPolylineLod(PolylineLod *lod)
+{
+  free(lod->indices);
+  free(lod->marks);
+  free(lod->stack);
+  InitPolylineLod(lod);
+}
+
+void InvalidatePolylineLod(PolylineLod *lod)
+{
+  lod->qtdPoints = -1;
+}
+
+void UpdatePolylineLod(PolylineLod *lod, const Points *line)
+{
+  int count = line->last + 1;
+
+  if (count == lod->qtdPoints) return;
+
+  if (count > lod->capacity)
+  {
+    int previousCapacity = lod->capacity;
+
+    lod->capacity = (count > 2*lod->capacity)? count : 2*lod->capacity;
+    lod->indices = (int *)realloc(lod->indices, POLYLINE_LOD_LEVELS*lod->capacity*sizeof(int));
+    lod->marks = (unsigned char *)realloc(lod->marks, lod->capacity);
+    lod->stack = (int *)realloc(lod->stack, 2*lod->capacity*sizeof(int));
+
+    // Levels sit capacity apart, the last one moves first so none is overwritten before it moves
+    for (int detail = POLYLINE_LOD_LEVELS - 1; detail > 0; detail--)
+    {
+      memmove(&lod->indices[detail*lod->capacity], &lod->indices[detail*previousCapacity], lod->counts[detail]*sizeof(int));
+    }
+  }
+
+  // Levels built for the first qtdPoints anchors stay valid up to their second to last kept anchor,
+  // only the segment to the old end was cut short by it. From there on the tail is simplified again.
+  bool appended = (lod->qtdPoints > 0) && (count > lod->qtdPoints);
+  int from = appended? lod->qtdPoints : 0;
+
+  lod->qtdPoints = count;
+
+  for (int i = from; i < count; i++) lod->indices[i] = i;
+  lod->counts[0] = count;
+
+  if (count == 0)
+  {
+    for (int detail = 1; detail < POLYLINE_LOD_LEVELS; detail++) lod->counts[detail] = 0;
+
+    return;
+  }
+
+  for (int detail = 1; detail < POLYLINE_LOD_LEVELS; detail++)
+  {
+    int *kept = &lod->indices[detail*lod->capacity];
+    int qtdKept = 0;
+    int first = 0;
+
+    if (appended && (lod->counts[detail] >= 2))
+    {
+      qtdKept = lod->counts[detail] - 2;
+      first = kept[qtdKept];
+
+      // A long straight run would otherwise be simplified again whole on every append
+      if (count - first > POLYLINE_LOD_MAX_TAIL)
+      {
+        qtdKept++;
+        first = kept[qtdKept];
+      }
+    }
+
+    lod->counts[detail] = qtdKept + SimplifyPolyline(line->points, first, count - 1, GetPolylineLodTolerance(detail), &kept[qtdKept], lod->marks, lod->stack);
+  }
+}
+
+int GetPolylineLodLevel(float zoom)
+{
+  int detail = 0;
+
+  while ((detail + 1 < POLYLINE_LOD_LEVELS) && (GetPolylineLodTolerance(detail + 1)*zoom <= POLYLINE_LOD_PIXEL_TOLERANCE)) detail++;
+
+  return detail;
+}
+
+// World units, 0 for the exact string
+float GetPolylineLodTolerance(int detail)
+{
+  return (detail == 0)? 0.0f : POLYLINE_LOD_MIN_TOLERANCE*(float)(1 << (detail - 1));
+}
+
+PolylineLodBenchmark BenchmarkPolylineLod(int count)
+{
+  PolylineLodBenchmark result = {0};
+  PolylineLod lod = {0};
+  Points line = {count, -1, (Vector2 *)malloc(((count > 0)? count : 1)*sizeof(Vector2)), false};
+  Vector2 point = {0, 0};
+  unsigned int x = 2463534242u;
+  int rebuilds = 16;
+
+  // Drifts to the right with some jitter, like a string laid while crossing a level
+  for (int i = 0; i < count; i++)
+  {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    point.x += (float)((int)(x%21u) - 5);
+    point.y += (float)((int)((x >> 8)%11u) - 5);
+    line.points[i] = point;
+  }
+
+  InitPolylineLod(&lod);
+
+  clock_t start = clock();
+  for (int i = 0; i < count; i++)
+  {
+    line.last = i;
+    UpdatePolylineLod(&lod, &line);
+  }
+  result.appendTime = (count > 0)? (double)(clock() - start)/CLOCKS_PER_SEC/count : 0.0;
+
+  start = clock();
+  for (int i = 0; i < rebuilds; i++)
+  {
+    InvalidatePolylineLod(&lod);
+    UpdatePolylineLod(&lod, &line);
+  }
+  result.rebuildTime = (double)(clock() - start)/CLOCKS_PER_SEC/rebuilds;
+
+  for (int detail = 0; detail < POLYLINE_LOD_LEVELS; detail++) result.counts[detail] = lod.counts[detail];
+
+  UnloadPolylineLod(&lod);
+  free(line.points);
+
+  return result;
+}
@@ -0,0 +1,54 @@
+#ifndef polyline // guardas de cabeçalho, impedem inclusões cíclicas
+#define polyline
+
+#include "raylib.h"
+
+#define POLYLINE_LOD_LEVELS 5
+#define POLYLINE_LOD_MIN_TOLERANCE 0.5f    // World units the first simplified level may stray, doubled by every next one
+#define POLYLINE_LOD_PIXEL_TOLERANCE 1.0f  // Screen pixels a drawn string may stray from the real one
+#define POLYLINE_LOD_MAX_TAIL 256          // Anchors simplified again on an append, past it the old end stays kept
+
+typedef struct Points
+{
+  int capacity;
+  int last;
+  Vector2 *points;
+  bool connected; // The last anchor sits on a goal that was set by this string
+} Points;
+
+// Douglas-Peucker simplifications of a string, one per tolerance. Level 0 keeps every
+// anchor, every anchor left out lies within the level tolerance of the kept segment
+// around it, so a kept segment grown by the tolerance covers the ones it replaces.
+typedef struct PolylineLod
+{
+  int qtdPoints;                    // Anchors the levels were built from, -1 when stale
+  int capacity;
+  int *indices;                     // [level*capacity + i], anchors kept by each level in order
+  int counts[POLYLINE_LOD_LEVELS];
+  unsigned char *marks;             // Simplification scratch, capacity anchors
+  int *stack;                       // Simplification scratch, 2*capacity indices
+} PolylineLod;
+
+typedef struct PolylineLodBenchmark
+{
+  double appendTime;                // Seconds per appended anchor, the levels kept up to date on every append
+  double rebuildTime;               // Seconds per rebuild of every level from scratch
+  int counts[POLYLINE_LOD_LEVELS];  // Anchors kept by each level at the end
+} PolylineLodBenchmark;
+
+void InitPolylineLod(PolylineLod *lod);
+void UnloadPolylineLod(PolylineLod *lod);
+// Call when the anchors change in any other way than being appended, undo and redo
+void InvalidatePolylineLod(PolylineLod *lod);
+// Appended anchors only simplify the tail of every level again, a smaller or invalidated string is rebuilt
+void UpdatePolylineLod(PolylineLod *lod, const Points *line);
+
+// Coarsest level that stays within POLYLINE_LOD_PIXEL_TOLERANCE on screen at the zoom
+int GetPolylineLodLevel(float zoom);
+float GetPolylineLodTolerance(int detail);
+
+// Synthetic string far longer than the game allows, a random walk of count anchors
+// appended one at a time, then rebuilt whole
+PolylineLodBenchmark BenchmarkPolylineLod(int count);
+
+#endif
@@ -29,6 +29,15 @@
 #include "draw_helpers.h"
 #include "shapes_helpers.h"
 #include "level.h"
+#include "polyline.h"
+#include "player.h"
+#include "string_crossing.h"
+#include "state_snapshot.h"
+#include "beam_tracer.h"
+#include "frame_pacing.h"
+#include "game_state.h"
+#include "sim_batch.h"
+#include "level_sdf.h"
 
 //----------------------------------------------------------------------------------
 // Defines and Macros
@@ -42,10 +51,6 @@
 #define LOG(...)
 #endif
 
-#define G 800
-#define PLAYER_JUMP_SPD 400.0f
-#define PLAYER_HOR_SPD 200.0f
-
 //----------------------------------------------------------------------------------
 // Types and Structures Definition
 //----------------------------------------------------------------------------------
@@ -57,51 +62,6 @@ typedef enum GameScreen
   ENDING
 } GameScreen;
 
-typedef struct Points
-{
-  int capacity;
-  int last;
-  Vector2 *points;
-} Points;
-
-typedef struct Player
-{
-  Rectangle rect;
-  float size;
-  Vector2 position;
-  float speed;
-  bool canJump;
-  Points redLine;
-  Points greenLine;
-  Points blueLine;
-  int selectedColor;
-} Player;
-
-typedef struct Goal
-{
-  Rectangle rect;
-  Color color;
-  bool isSet;
-} Goal;
-
-typedef struct LineSpawner
-{
-  Rectangle rect;
-  Color color;
-  bool activated;
-} LineSpawner;
-
-typedef struct Level
-{
-  int id;
-  int qtdSpawners;
-  LineSpawner *lineSpawners;
-  int qtdGoals;
-  Goal *goals;
-  int qtdEnvItems;
-  EnvItem *envItems;
-} Level;
-
 //----------------------------------------------------------------------------------
 // Global Variables Definition
 //----------------------------------------------------------------------------------
@@ -112,17 +72,22 @@ static RenderTexture2D target = {0}; // Render texture to render our game
 
 static Player player = {0};
 static Camera2D camera = {0};
+static StringIndex stringIndex = {0}; // Segments of every placed string, for the crossing rule
+static SnapshotHistory history = {0};  // Undo/redo of the player actions in the current level
+static bool showReach = false;         // Debug overlay of the platforms reachability
+static BeamPath beam = {0};            // Reused by every laser trace
+#if defined(SUPPORT_CUSTOM_FRAME_CONTROL) && !defined(PLATFORM_WEB)
+static FramePacer pacer = {0};         // Only drives the loop with custom frame control, see main()
+#endif
+static Shader glowShader = {0};        // Outline glow drawn from the level distance field
+static bool showGlow = true;
+static PolylineLod stringLods[3] = {0}; // Simplified red, green and blue strings, segments are drawn from them
 static Level level1 = {
-    .id = 1,
-    .qtdEnvItems = 5,
-    .qtdGoals = 1,
-    .qtdSpawners = 1};
+    .id = 1};
 
 static Level level2 = {
     .id = 2,
-    .qtdEnvItems = 6,
-    .qtdGoals = 1,
-    .qtdSpawners = 1};
+    .forbidCrossing = true};
 // static int envItemsLength;
 // static int spawnersLength;
 // static int goalsLength;
@@ -136,25 +101,63 @@ Level *currentLevel;
 // Module Functions Declaration
 //----------------------------------------------------------------------------------
 static void UpdateDrawFrame(void); // Update and Draw one frame
-void UpdatePlayer(Player *player, EnvItem *envItems, int envItemsLength,
-                  float delta);
-void UpdateCameraCenterInsideMap(Camera2D *camera, Player *player,
-                                 EnvItem *envItems, int envItemsLength,
+void UpdatePlayer(Player *player, Level *map, float delta);
+void UpdateCameraCenterInsideMap(Camera2D *camera, Player *player, Level *map,
                                  float delta, int width, int height);
-void NewLinePoint(Vector2 playerCenter, Player *player, EnvItem *envItems, int envItemsLength);
+static Points GetStringPoints(GameProgress *progress, int line);
+static void DrawPlayerLine(const Points *line, PolylineLod *lod, Color color, bool selected);
 static void Reset();
+static void RestoreSnapshot(const GameSnapshot *snapshot);
+static void DrawLasers(const Level *map, const GameProgress *progress);
+static void LoadLevels(void);
 
 //------------------------------------------------------------------------------------
 // Program main entry point
 //------------------------------------------------------------------------------------
-int main(void)
+int main(int argc, char *argv[])
 {
 #if !defined(_DEBUG)
   SetTraceLogLevel(LOG_NONE); // Disable raylib trace log messages
 #endif
 
+  LoadLevels();
+
+#if !defined(PLATFORM_WEB)
+  // Headless batch simulation benchmark, no window is opened
+  if ((argc > 1) && (strcmp(argv[1], "--sim-bench") == 0))
+  {
+    int instances = (argc > 2) ? atoi(argv[2]) : 4096;
+    double stepsPerSecond = BenchmarkSimBatch(&level2, (Vector2){400, 280}, instances, 1000);
+
+    LOG("%i instances: %.2f million steps per second\n", instances, stepsPerSecond / 1000000.0);
+    UnloadLevel(&level1);
+    UnloadLevel(&level2);
+    return 0;
+  }
+
+  // String simplification on a synthetic string, in game strings are too short to measure it
+  if ((argc > 1) && (strcmp(argv[1], "--lod-bench") == 0))
+  {
+    int anchors = (argc > 2) ? atoi(argv[2]) : 100000;
+    PolylineLodBenchmark result = BenchmarkPolylineLod(anchors);
+
+    LOG("%i anchors: append %.3f us, rebuild %.3f ms, kept", anchors, result.appendTime * 1e6, result.rebuildTime * 1000.0);
+    for (int i = 0; i < POLYLINE_LOD_LEVELS; i++)
+    {
+      LOG(" %i", result.counts[i]);
+    }
+    LOG("\n");
+    UnloadLevel(&level1);
+    UnloadLevel(&level2);
+    return 0;
+  }
+#endif
+
   // Initialization
   //--------------------------------------------------------------------------------------
+#if defined(SUPPORT_CUSTOM_FRAME_CONTROL) && !defined(PLATFORM_WEB)
+  SetConfigFlags(FLAG_VSYNC_HINT); // Present timing follows the vblank, the pacer measures it
+#endif
   InitWindow(screenWidth, screenHeight, "Strings");
 
   // TODO: Load resources / Initialize variables at this point
@@ -164,60 +167,25 @@ int main(void)
   target = LoadRenderTexture(screenWidth, screenHeight);
   SetTextureFilter(target.texture, TEXTURE_FILTER_BILINEAR);
 
-  player.position = (Vector2){400, 280};
-  player.speed = 0;
-  player.canJump = false;
-  player.size = 40;
-
-  level1.envItems = (EnvItem *)malloc(level1.qtdEnvItems * sizeof(EnvItem));
-  level1.envItems[0] = (EnvItem){{0, 0, 1000, 400}, 0, LIGHTGRAY};
-  level1.envItems[1] = (EnvItem){{0, 400, 1000, 200}, 1, GRAY};
-  level1.envItems[2] = (EnvItem){{300, 200, 400, 10}, 1, GRAY};
-  level1.envItems[3] = (EnvItem){{250, 300, 100, 10}, 1, GRAY};
-  level1.envItems[4] = (EnvItem){{650, 300, 100, 10}, 1, GRAY};
-
-  level1.lineSpawners = (LineSpawner *)malloc(level1.qtdSpawners * sizeof(LineSpawner));
-  level1.lineSpawners[0] = (LineSpawner){.color = RED, .activated = false, .rect = {.x = 200, .y = 375, .width = 10, .height = 25}};
-
-  level1.goals = (Goal *)malloc(level1.qtdGoals * sizeof(Goal));
-  level1.goals[0] = (Goal){.color = RED, .isSet = false, .rect = {.x = 600, .y = 300, .width = 50, .height = 100}};
-
-  level2.envItems = (EnvItem *)malloc(level2.qtdEnvItems * sizeof(EnvItem));
-  level2.envItems[0] = (EnvItem){{0, 0, 1000, 400}, 0, LIGHTGRAY};
-  level2.envItems[1] = (EnvItem){{0, 400, 1000, 200}, 1, GRAY};
-  level2.envItems[2] = (EnvItem){{300, 200, 400, 10}, 1, GRAY};
-  level2.envItems[3] = (EnvItem){{250, 300, 100, 10}, 1, GRAY};
-  level2.envItems[4] = (EnvItem){{650, 300, 100, 10}, 1, GRAY};
-  level2.envItems[5] = (EnvItem){{450, 200, 10, 200}, 1, GRAY};
-
-  level2.lineSpawners = (LineSpawner *)malloc(level2.qtdSpawners * sizeof(LineSpawner));
-  level2.lineSpawners[0] = (LineSpawner){.color = RED, .activated = false, .rect = {.x = 200, .y = 375, .width = 10, .height = 25}};
-
-  level2.goals = (Goal *)malloc(level2.qtdGoals * sizeof(Goal));
-  level2.goals[0] = (Goal){.color = RED, .isSet = false, .rect = {.x = 600, .y = 300, .width = 50, .height = 100}};
-
-  Points redLine;
-  redLine.last = -1;
-  redLine.capacity = 5;
-  redLine.points = (Vector2 *)malloc(redLine.capacity * sizeof(Vector2));
-  player.redLine = redLine;
-
-  Points greenLine;
-  greenLine.last = -1;
-  greenLine.capacity = 5;
-  greenLine.points = (Vector2 *)malloc(greenLine.capacity * sizeof(Vector2));
-  player.greenLine = greenLine;
-
-  Points blueLine;
-  blueLine.last = -1;
-  blueLine.capacity = 5;
-  blueLine.points = (Vector2 *)malloc(blueLine.capacity * sizeof(Vector2));
-  player.blueLine = blueLine;
+  // The distance fields are baked with the levels, only the textures need the window
+  UploadLevelSdf(&level1.sdf);
+  UploadLevelSdf(&level2.sdf);
+  glowShader = LoadLevelGlowShader();
 
   currentLevel = &level1;
+  player.size = PLAYER_SIZE;
+  player.state = InitGameState(currentLevel, (Vector2){400, 280});
+
+  InitStringIndex(&stringIndex);
+  InitSnapshotHistory(&history);
+  InitBeamPath(&beam, BEAM_MAX_BOUNCES);
+  for (int i = 0; i < 3; i++)
+  {
+    InitPolylineLod(&stringLods[i]);
+  }
+
+  ResetSnapshotHistory(&history, &player.state);
 
-  // envItemsLength = currentLevel->qtdEnvItems;
-  // goalsLength = currentLevel->qtdGoals;
 
   camera.target = Vector2Zero();
   camera.rotation = 0.0f;
@@ -227,6 +195,18 @@ int main(void)
 
 #if defined(PLATFORM_WEB)
   emscripten_set_main_loop(UpdateDrawFrame, 60, true);
+#elif defined(SUPPORT_CUSTOM_FRAME_CONTROL)
+  // raylib built with custom frame control leaves input polling, presenting and waiting to us,
+  // so input can be sampled right before the update instead of right after the previous present
+  InitFramePacer(&pacer, FRAME_PACING_LOW_LATENCY);
+  //--------------------------------------------------------------------------------------
+  // Main game loop
+  while (!WindowShouldClose()) // Detect window close button
+  {
+    BeginPacedFrame(&pacer);
+    UpdateDrawFrame();
+    EndPacedFrame(&pacer);
+  }
 #else
   SetTargetFPS(60); // Set our game frames-per-second
   //--------------------------------------------------------------------------------------
@@ -240,8 +220,18 @@ int main(void)
   // De-Initialization
   //--------------------------------------------------------------------------------------
   UnloadRenderTexture(target);
+  UnloadShader(glowShader);
 
   // TODO: Unload all loaded resources at this point
+  UnloadLevel(&level1);
+  UnloadLevel(&level2);
+  UnloadStringIndex(&stringIndex);
+  UnloadSnapshotHistory(&history);
+  UnloadBeamPath(&beam);
+  for (int i = 0; i < 3; i++)
+  {
+    UnloadPolylineLod(&stringLods[i]);
+  }
 
   CloseWindow(); // Close window and OpenGL context
   //--------------------------------------------------------------------------------------
@@ -257,7 +247,11 @@ static void UpdateDrawFrame(void)
 {
   // Update
   //----------------------------------------------------------------------------------
+#if defined(SUPPORT_CUSTOM_FRAME_CONTROL) && !defined(PLATFORM_WEB)
+  float deltaTime = pacer.frameTime; // EndDrawing no longer updates the raylib frame time
+#else
   float deltaTime = GetFrameTime();
+#endif
   Vector2 topLeft;
   topLeft = GetScreenToWorld2D((Vector2){0, 0}, camera);
 
@@ -285,14 +279,41 @@ static void UpdateDrawFrame(void)
   break;
   case GAMEPLAY:
   {
-    UpdatePlayer(&player, currentLevel->envItems, currentLevel->qtdEnvItems, deltaTime);
+    UpdateLevelEnv(currentLevel, deltaTime);
+    UpdatePlayer(&player, currentLevel, deltaTime);
 
     if (IsKeyPressed(KEY_R))
     {
-      Reset();
+      RestoreSnapshot(RestartSnapshot(&history));
+    }
+
+    if (IsKeyPressed(KEY_Z))
+    {
+      RestoreSnapshot(UndoSnapshot(&history));
     }
-    UpdateCameraCenterInsideMap(&camera, &player, currentLevel->envItems, currentLevel->qtdEnvItems,
-                                deltaTime, screenWidth, screenHeight);
+
+    if (IsKeyPressed(KEY_Y))
+    {
+      RestoreSnapshot(RedoSnapshot(&history));
+    }
+
+    if (IsKeyPressed(KEY_F1))
+    {
+      showReach = !showReach;
+    }
+
+    if (IsKeyPressed(KEY_F3))
+    {
+      showGlow = !showGlow;
+    }
+
+#if defined(SUPPORT_CUSTOM_FRAME_CONTROL) && !defined(PLATFORM_WEB)
+    if (IsKeyPressed(KEY_F2))
+    {
+      pacer.mode = (pacer.mode == FRAME_PACING_LOW_LATENCY) ? FRAME_PACING_THROUGHPUT : FRAME_PACING_LOW_LATENCY;
+    }
+#endif
+    UpdateCameraCenterInsideMap(&camera, &player, currentLevel, deltaTime, screenWidth, screenHeight);
 
     //----------------------------------------------------------------------------------
 
@@ -339,36 +360,75 @@ static void UpdateDrawFrame(void)
     DrawFPS(100, 100);
     DrawText("Press C to create a point of the selected Color", (int)(topLeft.x + 10), (int)(topLeft.y + 10), 20, BLACK);
 
-    for (int i = 0; i < currentLevel->qtdEnvItems; i++)
+    EntityStore *entities = &currentLevel->entities;
+    EntityQuery items = QueryEntities(entities, COMPONENT_BIT(COMPONENT_TRANSFORM) | COMPONENT_BIT(COMPONENT_RENDERABLE), COMPONENT_BIT(COMPONENT_TRIGGER));
+    while (NextEntity(&items))
     {
-      DrawRectangleRec(currentLevel->envItems[i].rect, currentLevel->envItems[i].color);
+      DrawRectangleRec(*GetEntityRect(entities, items.entity), *GetEntityColor(entities, items.entity));
+    }
+
+    if (showGlow)
+    {
+      DrawLevelGlow(&currentLevel->sdf, glowShader, Fade(SKYBLUE, 0.8f), 12.0f);
+    }
+
+    if (showReach)
+    {
+      int playerSurface = FindReachSurface(&currentLevel->reach, player.state.position);
+      DrawReachGraph(&currentLevel->reach, playerSurface);
+
+      for (int i = 0; i < CountComponents(entities, COMPONENT_SPAWNER); i++)
+      {
+        if (!IsSpawnerReachable(&currentLevel->reach, playerSurface, i))
+        {
+          DrawRectangleLinesEx(*GetEntityRect(entities, GetComponentOwner(entities, COMPONENT_SPAWNER, i)), 3.0f, MAROON);
+        }
+      }
+
+      for (int i = 0; i < CountComponents(entities, COMPONENT_GOAL); i++)
+      {
+        if (!IsGoalReachable(&currentLevel->reach, playerSurface, i))
+        {
+          DrawRectangleLinesEx(*GetEntityRect(entities, GetComponentOwner(entities, COMPONENT_GOAL, i)), 3.0f, MAROON);
+        }
+      }
     }
 
-    for (int i = 0; i < currentLevel->qtdSpawners; i++)
+    EntityQuery spawners = QueryEntities(entities, COMPONENT_BIT(COMPONENT_SPAWNER) | COMPONENT_BIT(COMPONENT_TRANSFORM), 0);
+    while (NextEntity(&spawners))
     {
-      if (CheckCollisionRecs(player.rect, currentLevel->lineSpawners[i].rect))
+      Rectangle rect = *GetEntityRect(entities, spawners.entity);
+
+      if (GetEntityTrigger(entities, spawners.entity)->playerInside)
       {
-        DrawText("E", (int)(currentLevel->lineSpawners[i].rect.x + 15), (int)(currentLevel->lineSpawners[i].rect.y - 35), 30, BLACK);
+        DrawText("E", (int)(rect.x + 15), (int)(rect.y - 35), 30, BLACK);
       }
-      DrawRectangleRec(currentLevel->lineSpawners[i].rect, currentLevel->lineSpawners[i].color);
+      DrawRectangleRec(rect, *GetEntityColor(entities, spawners.entity));
     }
 
-    for (int i = 0; i < currentLevel->qtdGoals; i++)
+    // Goal flags are indexed in goal component order
+    for (int i = 0; i < CountComponents(entities, COMPONENT_GOAL); i++)
     {
-      if (currentLevel->goals[i].isSet)
+      int goal = GetComponentOwner(entities, COMPONENT_GOAL, i);
+      Rectangle rect = *GetEntityRect(entities, goal);
+      Color color = *GetEntityColor(entities, goal);
+
+      if (player.state.progress.goalsSet & (1u << i))
       {
-        DrawRectangleRec(currentLevel->goals[i].rect, currentLevel->goals[i].color);
+        DrawRectangleRec(rect, color);
       }
       else
       {
-        if (CheckCollisionRecs(player.rect, currentLevel->goals[i].rect))
+        if (GetEntityTrigger(entities, goal)->playerInside)
         {
-          DrawText("C", (int)(currentLevel->goals[i].rect.x + 15), (int)(currentLevel->goals[i].rect.y - 35), 30, BLACK);
+          DrawText("C", (int)(rect.x + 15), (int)(rect.y - 35), 30, BLACK);
         }
-        DrawRectangleLinesEx(currentLevel->goals[i].rect, 1.0f, currentLevel->goals[i].color);
+        DrawRectangleLinesEx(rect, 1.0f, color);
       }
     }
 
+    DrawLasers(currentLevel, &player.state.progress);
+
     // char *playerX;
     // asprintf(&playerX, "x = %d\n", player.position.x);
     // char *playerY;
@@ -377,13 +437,13 @@ static void UpdateDrawFrame(void)
     // DrawText(playerX, 150, 140, 30, BLACK);
     // DrawText(playerY, 150, 180, 30, BLACK);
 
-    player.rect = (Rectangle){player.position.x - (player.size / 2.0f), player.position.y - player.size, player.size,
+    player.rect = (Rectangle){player.state.position.x - (player.size / 2.0f), player.state.position.y - player.size, player.size,
                               player.size};
     DrawRectangleRec(player.rect, RED);
 
     // DrawCircleV(player.position, 5.0f, GOLD);
 
-    switch (player.selectedColor)
+    switch (player.state.progress.selectedColor)
     {
     case 1:
       DrawText("Red", (int)(topLeft.x + 10), (int)(topLeft.y + 30), 30, BLACK);
@@ -399,93 +459,14 @@ static void UpdateDrawFrame(void)
       break;
     }
 
-    for (int i = 0; i <= player.redLine.last; i++)
-    {
-      bool allGoalsReached = true;
-      for (int j = 0; j < currentLevel->qtdGoals; j++)
-      {
-        if (ColorIsEqual(currentLevel->goals[j].color, RED))
-        {
-          allGoalsReached &= CheckCollisionPointRec(player.redLine.points[i], currentLevel->goals[j].rect);
-        }
-      }
-
-      if (!allGoalsReached)
-      {
-        if (i == player.redLine.last && i < player.redLine.capacity - 1 && player.selectedColor == 1)
-        {
-          DrawClampedLine(player.redLine.points[i].x, player.redLine.points[i].y, player.position.x, player.position.y - (player.size / 2), 500, RED);
-        }
-        else if (i < player.redLine.last)
-        {
-          DrawClampedLine(player.redLine.points[i].x, player.redLine.points[i].y, player.redLine.points[i + 1].x, player.redLine.points[i + 1].y, 500, RED);
-        }
-      }
-
-      DrawCircleV(player.redLine.points[i], 5.0f, GOLD);
-    }
-
-    for (int i = 0; i <= player.greenLine.last; i++)
-    {
-      bool allGoalsReached = true;
-      for (int j = 0; j < currentLevel->qtdGoals; j++)
-      {
-
-        if (ColorIsEqual(currentLevel->goals[j].color, RED))
-        {
-          allGoalsReached &= CheckCollisionPointRec(player.greenLine.points[i], currentLevel->goals[j].rect);
-        }
-      }
-
-      if (!allGoalsReached)
-      {
-        if (i == player.greenLine.last && i < player.greenLine.capacity - 1 && player.selectedColor == 2)
-        {
-          DrawClampedLine(player.greenLine.points[i].x, player.greenLine.points[i].y, player.position.x, player.position.y - (player.size / 2), 500, GREEN);
-        }
-        else if (i < player.greenLine.last)
-        {
-          DrawClampedLine(player.greenLine.points[i].x, player.greenLine.points[i].y, player.greenLine.points[i + 1].x, player.greenLine.points[i + 1].y, 500, GREEN);
-        }
-      }
-
-      DrawCircleV(player.greenLine.points[i], 5.0f, GOLD);
-    }
-
-    for (int i = 0; i <= player.blueLine.last; i++)
-    {
-      bool allGoalsReached = true;
-      for (int j = 0; j < currentLevel->qtdGoals; j++)
-      {
-
-        if (ColorIsEqual(currentLevel->goals[j].color, RED))
-        {
-          allGoalsReached &= CheckCollisionPointRec(player.blueLine.points[i], currentLevel->goals[j].rect);
-        }
-      }
-
-      if (!allGoalsReached)
-      {
-        if (i == player.blueLine.last && i < player.blueLine.capacity - 1 && player.selectedColor == 3)
-        {
-          DrawClampedLine(player.blueLine.points[i].x, player.blueLine.points[i].y, player.position.x, player.position.y - (player.size / 2), 500, BLUE);
-        }
-        else if (i < player.blueLine.last)
-        {
-          DrawClampedLine(player.blueLine.points[i].x, player.blueLine.points[i].y, player.blueLine.points[i + 1].x, player.blueLine.points[i + 1].y, 500, BLUE);
-        }
-      }
-
-      DrawCircleV(player.blueLine.points[i], 5.0f, GOLD);
-    }
-
-    bool allGoalsReached = true;
-    for (int i = 0; i < currentLevel->qtdGoals; i++)
-    {
-      allGoalsReached &= currentLevel->goals[i].isSet;
-    }
+    Points redLine = GetStringPoints(&player.state.progress, 0);
+    Points greenLine = GetStringPoints(&player.state.progress, 1);
+    Points blueLine = GetStringPoints(&player.state.progress, 2);
+    DrawPlayerLine(&redLine, &stringLods[0], RED, player.state.progress.selectedColor == 1);
+    DrawPlayerLine(&greenLine, &stringLods[1], GREEN, player.state.progress.selectedColor == 2);
+    DrawPlayerLine(&blueLine, &stringLods[2], BLUE, player.state.progress.selectedColor == 3);
 
-    if (allGoalsReached) {
+    if (player.state.progress.qtdGoalsRemaining == 0) {
       currentLevelId++;
 
       if (currentLevelId == 2) {
@@ -528,6 +509,12 @@ static void UpdateDrawFrame(void)
                  (Vector2){0, 0}, 0.0f, WHITE);
 
   // TODO: Draw everything that requires to be drawn at this point, maybe UI?
+#if defined(SUPPORT_CUSTOM_FRAME_CONTROL) && !defined(PLATFORM_WEB)
+  if (currentScreen == GAMEPLAY)
+  {
+    DrawFramePacerStats(&pacer, screenWidth - 200, 10);
+  }
+#endif
 
   EndDrawing();
   //----------------------------------------------------------------------------------
@@ -536,194 +523,225 @@ static void UpdateDrawFrame(void)
 void Reset()
 {
   camera.zoom = 1.0f;
-  player.position = (Vector2){400, 280};
+  player.state = InitGameState(currentLevel, (Vector2){400, 280});
+  ResetLevelEnv(currentLevel);
 
-  for (int i = 0; i < currentLevel->qtdGoals; i++)
-  {
-    currentLevel->goals[i].isSet = false;
-  }
+  ClearStringIndex(&stringIndex);
+  ResetSnapshotHistory(&history, &player.state);
 
-  for (int i = 0; i < currentLevel->qtdSpawners; i++)
+  for (int i = 0; i < 3; i++)
   {
-    currentLevel->lineSpawners[i].activated = false;
+    InvalidatePolylineLod(&stringLods[i]);
   }
-
-  player.redLine.last = -1;
-  free(player.redLine.points);
-  player.redLine.points = (Vector2 *)malloc(5 * sizeof(Vector2));
-
-  player.greenLine.last = -1;
-  free(player.greenLine.points);
-  player.greenLine.points = (Vector2 *)malloc(5 * sizeof(Vector2));
-
-  player.blueLine.last = -1;
-  free(player.blueLine.points);
-  player.blueLine.points = (Vector2 *)malloc(5 * sizeof(Vector2));
 }
 
-void UpdatePlayer(Player *player, EnvItem *envItems, int envItemsLength,
-                  float delta)
+// Puts the game back in a state from the undo history, NULL when there is nothing to undo/redo
+static void RestoreSnapshot(const GameSnapshot *snapshot)
 {
-  Vector2 playerCenter = (Vector2){player->position.x, player->position.y - player->size / 2};
-
-  if (IsKeyPressed(KEY_Q))
+  if (snapshot == NULL)
   {
-    player->selectedColor = 0;
-    for (int i = 0; i < currentLevel->qtdSpawners; i++)
-    {
-      currentLevel->lineSpawners[i].activated = false;
-    }
+    return;
   }
 
-  if (IsKeyPressed(KEY_E))
-  {
-    for (int i = 0; i < currentLevel->qtdSpawners; i++)
-    {
-      if (CheckCollisionRecs(player->rect, currentLevel->lineSpawners[i].rect))
-      {
-        if (ColorIsEqual(currentLevel->lineSpawners[i].color, RED))
-        {
-          player->selectedColor = 1;
-        }
-
-        if (ColorIsEqual(currentLevel->lineSpawners[i].color, GREEN))
-        {
-          player->selectedColor = 2;
-        }
+  ApplySnapshot(snapshot, &player.state);
 
-        if (ColorIsEqual(currentLevel->lineSpawners[i].color, BLUE))
-        {
-          player->selectedColor = 3;
-        }
+  Points strings[GAME_LINES] = {GetStringPoints(&player.state.progress, 0), GetStringPoints(&player.state.progress, 1),
+                                GetStringPoints(&player.state.progress, 2)};
+  Points *lines[GAME_LINES] = {&strings[0], &strings[1], &strings[2]};
+  RebuildStringIndex(&stringIndex, lines, GAME_LINES);
 
-        if (player->selectedColor != 0 && !currentLevel->lineSpawners[i].activated)
-        {
-          currentLevel->lineSpawners[i].activated = true;
-          NewLinePoint((Vector2){currentLevel->lineSpawners[i].rect.x + currentLevel->lineSpawners[i].rect.width / 2, currentLevel->lineSpawners[i].rect.y + currentLevel->lineSpawners[i].rect.height / 2}, player, envItems, envItemsLength);
-          break;
-        }
-      }
-    }
+  // Undo and redo can swap anchors without changing how many there are
+  for (int i = 0; i < 3; i++)
+  {
+    InvalidatePolylineLod(&stringLods[i]);
   }
 
-  if (IsKeyPressed(KEY_C))
+#if defined(_DEBUG)
+  if (currentLevel->forbidCrossing && FindStringsCrossing(lines, GAME_LINES, NULL, NULL))
   {
-    bool setGoal = false;
-    for (int i = 0; i < currentLevel->qtdGoals; i++)
-    {
-      LineRecColisions colisions;
-      if ((player->selectedColor == 1 && ColorIsEqual(currentLevel->goals[i].color, RED) && !CheckLineEnvColision((Line){player->redLine.points[player->redLine.last], playerCenter}, envItems, envItemsLength, &colisions)) ||
-          (player->selectedColor == 2 && ColorIsEqual(currentLevel->goals[i].color, GREEN) && !CheckLineEnvColision((Line){player->greenLine.points[player->greenLine.last], playerCenter}, envItems, envItemsLength, &colisions)) ||
-          (player->selectedColor == 3 && ColorIsEqual(currentLevel->goals[i].color, BLUE) && !CheckLineEnvColision((Line){player->blueLine.points[player->blueLine.last], playerCenter}, envItems, envItemsLength, &colisions)))
-      {
-        if (CheckCollisionRecs(player->rect, currentLevel->goals[i].rect))
-        {
-          currentLevel->goals[i].isSet = true;
-          NewLinePoint((Vector2){currentLevel->goals[i].rect.x + currentLevel->goals[i].rect.width / 2, currentLevel->goals[i].rect.y + currentLevel->goals[i].rect.height / 2}, player, envItems, envItemsLength);
-          setGoal = true;
-          player->selectedColor = 0;
-        }
-      }
-    }
-
-    if (!setGoal)
-    {
-      NewLinePoint(playerCenter, player, envItems, envItemsLength);
-    }
+    LOG("Restored strings cross each other\n");
   }
+#endif
+}
+
+// Same step as the headless game, ApplyGameInput for the keys and the lasers, StepPlayerBody for the body
+void UpdatePlayer(Player *player, Level *map, float delta)
+{
+  GameState *state = &player->state;
+  GameInput input = {0};
+  Rectangle playerRect = GetPlayerRect(state->position);
 
   if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT))
-    player->position.x -= PLAYER_HOR_SPD * delta;
+    input.move -= 1;
   if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT))
-    player->position.x += PLAYER_HOR_SPD * delta;
-  if (IsKeyDown(KEY_SPACE) && player->canJump)
+    input.move += 1;
+  input.jump = IsKeyDown(KEY_SPACE);
+  input.interact = IsKeyPressed(KEY_E);
+  input.create = IsKeyPressed(KEY_C);
+  input.clear = IsKeyPressed(KEY_Q);
+
+  // Triggers only feed the hints and the laser previews now
+  UpdateLevelTriggers(map, playerRect);
+
+  GameProgress previous = state->progress;
+
+  ApplyGameInput(&state->progress, map, playerRect, input, &stringIndex);
+
+  unsigned int changes = GetSnapshotChanges(&state->progress, &previous);
+
+  if (changes != 0)
   {
-    player->speed = -PLAYER_JUMP_SPD;
-    player->canJump = false;
+    PushSnapshot(&history, state, changes);
   }
 
-  bool hitObstacle = false;
-  for (int i = 0; i < envItemsLength; i++)
+  StepPlayerBody(map, &state->position, &state->speed, &state->canJump, &state->groundItem, input.move, input.jump, delta);
+  state->steps++;
+}
+
+// Active lasers are drawn solid, the one the player stands next to shows a preview of its beam
+static void DrawLasers(const Level *map, const GameProgress *progress)
+{
+  const SpawnerState *spawners = (const SpawnerState *)GetComponentArray(&map->entities, COMPONENT_SPAWNER);
+
+  for (int i = 0; i < CountComponents(&map->entities, COMPONENT_SPAWNER); i++)
   {
-    EnvItem const *ei = envItems + i;
-    Vector2 *p = &(player->position);
-    if (ei->blocking && ei->rect.x <= p->x &&
-        ei->rect.x + ei->rect.width >= p->x && ei->rect.y >= p->y &&
-        ei->rect.y <= p->y + player->speed * delta)
+    int entity = GetComponentOwner(&map->entities, COMPONENT_SPAWNER, i);
+    bool active = (progress->spawnersActive & (1u << i)) != 0;
+    Rectangle rect = *GetEntityRect(&map->entities, entity);
+    Color color = *GetEntityColor(&map->entities, entity);
+
+    if (!spawners[i].laser || (!active && !GetEntityTrigger(&map->entities, entity)->playerInside))
     {
-      hitObstacle = true;
-      player->speed = 0.0f;
-      p->y = ei->rect.y;
-      break;
+      continue;
     }
-  }
 
-  if (!hitObstacle)
-  {
-    player->position.y += player->speed * delta;
-    player->speed += G * delta;
-    player->canJump = false;
+    Vector2 origin = {rect.x + rect.width / 2, rect.y + rect.height / 2};
+    TraceBeam(&beam, map, origin, spawners[i].direction, BEAM_LENGTH, color, progress->goalsSet);
+    DrawBeamPath(&beam, active ? 3.0f : 1.0f, active ? color : Fade(color, 0.5f));
   }
-  else
-    player->canJump = true;
 }
 
-void NewLinePoint(Vector2 lineEndPoint, Player *player, EnvItem *envItems, int envItemsLength)
+// Levels only hold data, they are built before the window so the headless modes can use them
+static void LoadLevels(void)
 {
-  printf("NewLinePoint\n");
-  LineRecColisions colisions;
+  AddLevelItem(&level1, (Rectangle){0, 0, 1000, 400}, false, LIGHTGRAY);
+  AddLevelItem(&level1, (Rectangle){0, 400, 1000, 200}, true, GRAY);
+  AddLevelItem(&level1, (Rectangle){300, 200, 400, 10}, true, GRAY);
+  AddLevelItem(&level1, (Rectangle){250, 300, 100, 10}, true, GRAY);
+  AddLevelItem(&level1, (Rectangle){650, 300, 100, 10}, true, GRAY);
+  SetLevelItemPath(&level1, AddLevelItem(&level1, (Rectangle){820, 350, 100, 10}, true, GRAY), (Vector2){0, -150}, 4.0f);
+
+  AddLevelSpawner(&level1, (Rectangle){.x = 200, .y = 375, .width = 10, .height = 25}, RED);
+
+  AddLevelGoal(&level1, (Rectangle){.x = 600, .y = 300, .width = 50, .height = 100}, RED);
+  InitLevelEnv(&level1);
+  BuildLevelReach(&level1, (Vector2){400, 280}, PLAYER_SIZE);
+  BakeLevelSdf(&level1);
+
+  AddLevelItem(&level2, (Rectangle){0, 0, 1000, 400}, false, LIGHTGRAY);
+  AddLevelItem(&level2, (Rectangle){0, 400, 1000, 200}, true, GRAY);
+  AddLevelItem(&level2, (Rectangle){300, 200, 400, 10}, true, GRAY);
+  AddLevelItem(&level2, (Rectangle){250, 300, 100, 10}, true, GRAY);
+  AddLevelItem(&level2, (Rectangle){650, 300, 100, 10}, true, GRAY);
+  AddLevelItem(&level2, (Rectangle){450, 200, 10, 200}, true, GRAY);
+  AddLevelMirror(&level2, (Rectangle){200, 40, 200, 10}, SKYBLUE);
+
+  AddLevelSpawner(&level2, (Rectangle){.x = 200, .y = 375, .width = 10, .height = 25}, RED);
+  AddLevelLaser(&level2, (Rectangle){.x = 80, .y = 375, .width = 10, .height = 25}, BLUE, (Vector2){1, -2});
+
+  AddLevelGoal(&level2, (Rectangle){.x = 600, .y = 300, .width = 50, .height = 100}, RED);
+  AddLevelGoal(&level2, (Rectangle){.x = 300, .y = 150, .width = 30, .height = 30}, BLUE);
+  InitLevelEnv(&level2);
+  BuildLevelReach(&level2, (Vector2){400, 280}, PLAYER_SIZE);
+  BakeLevelSdf(&level2);
+}
+
+// Points view over a string of the game state, for the drawing, the crossing index and the simplification
+static Points GetStringPoints(GameProgress *progress, int line)
+{
+  return (Points){GAME_MAX_ANCHORS, progress->qtdAnchors[line] - 1, progress->anchors[line], (progress->connected & (1u << line)) != 0};
+}
+
+// Draws the anchors and segments of a string, plus the segment to the player while it is being extended.
+// Segments come from the coarsest simplification that stays within a pixel at the zoom, and only the parts
+// that can be on screen are drawn.
+static void DrawPlayerLine(const Points *line, PolylineLod *lod, Color color, bool selected)
+{
+  UpdatePolylineLod(lod, line);
+
+  int detail = GetPolylineLodLevel(camera.zoom);
+  const int *kept = &lod->indices[detail * lod->capacity];
+  float margin = GetPolylineLodTolerance(detail) + 5.0f; // Simplification error and anchor radius
+  Vector2 topLeft = GetScreenToWorld2D((Vector2){0, 0}, camera);
+  Vector2 bottomRight = GetScreenToWorld2D((Vector2){(float)screenWidth, (float)screenHeight}, camera);
+  Rectangle view = {topLeft.x - margin, topLeft.y - margin, bottomRight.x - topLeft.x + 2 * margin, bottomRight.y - topLeft.y + 2 * margin};
 
-  switch (player->selectedColor)
+  for (int k = 0; k < lod->counts[detail]; k++)
   {
-  case 1:
-    printf("selectedColor = 1\n");
-    if (player->redLine.last < player->redLine.capacity - 1 && (player->redLine.last == -1 || !CheckLineEnvColision((Line){player->redLine.points[player->redLine.last], lineEndPoint}, envItems, envItemsLength, &colisions)))
-    {
-      player->redLine.points[player->redLine.last + 1] = lineEndPoint;
-      player->redLine.last++;
-    }
-    break;
-  case 2:
-    printf("selectedColor = 2\n");
-    if (player->greenLine.last < player->greenLine.capacity - 1 && (player->greenLine.last == -1 || !CheckLineEnvColision((Line){player->greenLine.points[player->greenLine.last], lineEndPoint}, envItems, envItemsLength, &colisions)))
+    int i = kept[k];
+
+    if (k + 1 < lod->counts[detail])
     {
-      player->greenLine.points[player->greenLine.last + 1] = lineEndPoint;
-      player->greenLine.last++;
+      int j = kept[k + 1];
+      Vector2 a = line->points[i];
+      Vector2 b = line->points[j];
+      Rectangle box = {fminf(a.x, b.x), fminf(a.y, b.y), fabsf(b.x - a.x), fabsf(b.y - a.y)};
+
+      if (CheckCollisionRecs(box, view))
+      {
+        DrawClampedLine(a.x, a.y, b.x, b.y, 500, color);
+
+        // Anchors the segment replaces lie within the tolerance of it, so they are only
+        // looked at when it can be on screen
+        for (int m = i; m < j; m++)
+        {
+          if (CheckCollisionPointRec(line->points[m], view))
+          {
+            DrawCircleV(line->points[m], 5.0f, GOLD);
+          }
+        }
+      }
     }
-    break;
-  case 3:
-    printf("selectedColor = 3\n");
-    if (player->blueLine.last < player->blueLine.capacity - 1 && (player->blueLine.last == -1 || !CheckLineEnvColision((Line){player->blueLine.points[player->blueLine.last], lineEndPoint}, envItems, envItemsLength, &colisions)))
+    else if (selected && !line->connected && i < line->capacity - 1)
     {
-      player->blueLine.points[player->blueLine.last + 1] = lineEndPoint;
-      player->blueLine.last++;
+      // Solid up to the first platform in the way, an anchor can not be placed through it,
+      // past it the rest is faded with a mark on every border the string would have to cross
+      Line preview = {line->points[i], {player.state.position.x, player.state.position.y - (player.size / 2)}};
+      Vector2 end = GetLineLevelClosestColisionVector2(preview, currentLevel);
+      DrawClampedLine(preview.start.x, preview.start.y, end.x, end.y, 500, color);
+
+      LineHit hits[8];
+      int qtdHits = GetLineLevelHits(preview, currentLevel, hits, sizeof(hits) / sizeof(hits[0]));
+
+      if (qtdHits > 0 && (end.x != preview.end.x || end.y != preview.end.y))
+      {
+        DrawClampedLine(end.x, end.y, preview.end.x, preview.end.y, 500, Fade(color, 0.3f));
+
+        for (int h = 0; h < qtdHits; h++)
+        {
+          DrawCircleV(hits[h].point, 3.0f, Fade(color, 0.6f));
+        }
+      }
     }
-    break;
+  }
 
-  default:
-    break;
+  if (line->last >= 0 && CheckCollisionPointRec(line->points[line->last], view))
+  {
+    DrawCircleV(line->points[line->last], 5.0f, GOLD);
   }
 }
 
-void UpdateCameraCenterInsideMap(Camera2D *camera, Player *player,
-                                 EnvItem *envItems, int envItemsLength,
+void UpdateCameraCenterInsideMap(Camera2D *camera, Player *player, Level *map,
                                  float delta, int width, int height)
 {
-  camera->target = player->position;
+  camera->target = player->state.position;
   camera->offset = (Vector2){(float)width / 2.0f, (float)height / 2.0f};
-  float minX = 1000;
-  float minY = 1000;
-  float maxX = -1000;
-  float maxY = -1000;
 
-  for (int i = 0; i < envItemsLength; i++)
-  {
-    EnvItem const *ei = envItems + i;
-    minX = fminf(ei->rect.x, minX);
-    maxX = fmaxf(ei->rect.x + ei->rect.width, maxX);
-    minY = fminf(ei->rect.y, minY);
-    maxY = fmaxf(ei->rect.y + ei->rect.height, maxY);
-  }
+  // Bounds are computed once at load and already cover the movers paths
+  float minX = map->bounds.x;
+  float minY = map->bounds.y;
+  float maxX = map->bounds.x + map->bounds.width;
+  float maxY = map->bounds.y + map->bounds.height;
 
   Vector2 max = GetWorldToScreen2D((Vector2){maxX, maxY}, *camera);
   Vector2 min = GetWorldToScreen2D((Vector2){minX, minY}, *camera);
@@ -0,0 +1,342 @@
+#include "raylib.h"
+
+#include "reachability.h"
+#include "level.h"
+#include "player.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Horizontal range of positions the player can be at, while in the air
+typedef struct ReachSpan
+{
+    float left;
+    float right;
+} ReachSpan;
+
+typedef struct ReachEvent
+{
+    float time;
+    float y;
+    int surface;
+} ReachEvent;
+
+// Tops crossed on the same step are landed on from the highest one down, like FindLevelGround does
+static int CompareReachEvents(const void *a, const void *b)
+{
+    const ReachEvent *ea = (const ReachEvent *)a;
+    const ReachEvent *eb = (const ReachEvent *)b;
+
+    if (ea->time != eb->time) return (ea->time < eb->time)? -1 : 1;
+
+    return (ea->y < eb->y)? -1 : (ea->y > eb->y)? 1 : 0;
+}
+
+// The player moves by the speed before gravity is added, the positions after every step of that kind
+// lie on the parabola launched G*step/2 faster, which rises about 3 units higher on a full jump
+static float GetStepLaunchSpeed(float jumpSpeed)
+{
+    return jumpSpeed + G*REACH_STEP_TIME/2.0f;
+}
+
+// A top crossed during a step is landed on at the end of it, after the horizontal move of the whole step
+static float GetStepLandingTime(float time)
+{
+    return ceilf(time/REACH_STEP_TIME - 0.001f)*REACH_STEP_TIME;
+}
+
+// Steering at full speed widens every span, spans that meet are merged
+static int ExpandSpans(ReachSpan *spans, int count, float distance)
+{
+    int merged = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        ReachSpan span = {spans[i].left - distance, spans[i].right + distance};
+
+        if ((merged > 0) && (span.left <= spans[merged - 1].right)) spans[merged - 1].right = fmaxf(spans[merged - 1].right, span.right);
+        else spans[merged++] = span;
+    }
+
+    return merged;
+}
+
+// Removes the part of the spans that lands on the surface, scratch holds count + 1 spans
+static int CutSpans(ReachSpan *spans, int count, const ReachSurface *surface, bool *hit, ReachSpan *scratch)
+{
+    int result = 0;
+    *hit = false;
+
+    for (int i = 0; i < count; i++)
+    {
+        ReachSpan span = spans[i];
+
+        if ((span.right < surface->left) || (span.left > surface->right))
+        {
+            scratch[result++] = span;
+            continue;
+        }
+
+        *hit = true;
+        // Landing is inclusive on both edges, so what is left starts just outside the surface
+        if (span.left < surface->left) scratch[result++] = (ReachSpan){span.left, nextafterf(surface->left, -INFINITY)};
+        if (span.right > surface->right) scratch[result++] = (ReachSpan){nextafterf(surface->right, INFINITY), span.right};
+    }
+
+    memcpy(spans, scratch, result*sizeof(ReachSpan));
+
+    return result;
+}
+
+// Follows every trajectory leaving the surface with upward speed jumpSpeed in time order,
+// the first surface top crossed while falling catches the part of the spans above it
+static void TraceReachArcs(ReachGraph *graph, int from, float jumpSpeed, ReachEvent *events, ReachSpan *spans, ReachSpan *scratch)
+{
+    const ReachSurface *origin = &graph->surfaces[from];
+    float launchSpeed = GetStepLaunchSpeed(jumpSpeed);
+    int qtdEvents = 0;
+    int qtdSpans = 0;
+
+    for (int i = 0; i < graph->qtdSurfaces; i++)
+    {
+        float drop = graph->surfaces[i].y - origin->y;
+        float discriminant = launchSpeed*launchSpeed + 2.0f*G*drop;
+
+        if ((jumpSpeed == 0.0f) && (i == from)) continue;
+        if ((discriminant < 0.0f) || ((jumpSpeed == 0.0f) && (drop < 0.0f))) continue;
+
+        // Later root of origin.y - v*t + G*t^2/2 = surface.y, the one on the way down
+        float time = GetStepLandingTime((launchSpeed + sqrtf(discriminant))/G);
+        events[qtdEvents++] = (ReachEvent){time, graph->surfaces[i].y, i};
+    }
+
+    qsort(events, qtdEvents, sizeof(ReachEvent), CompareReachEvents);
+
+    if (jumpSpeed > 0.0f)
+    {
+        spans[qtdSpans++] = (ReachSpan){origin->left, origin->right};
+    }
+    else
+    {
+        // Walking off either edge
+        spans[qtdSpans++] = (ReachSpan){nextafterf(origin->left, -INFINITY), nextafterf(origin->left, -INFINITY)};
+        spans[qtdSpans++] = (ReachSpan){nextafterf(origin->right, INFINITY), nextafterf(origin->right, INFINITY)};
+    }
+
+    float time = 0.0f;
+
+    for (int e = 0; (e < qtdEvents) && (qtdSpans > 0); e++)
+    {
+        bool hit = false;
+
+        qtdSpans = ExpandSpans(spans, qtdSpans, PLAYER_HOR_SPD*(events[e].time - time));
+        qtdSpans = CutSpans(spans, qtdSpans, &graph->surfaces[events[e].surface], &hit, scratch);
+        time = events[e].time;
+
+        if (hit && (events[e].surface != from)) graph->edges[from*graph->qtdSurfaces + events[e].surface] = 1;
+    }
+}
+
+// Standing on the surface, or jumping straight up from it, overlaps the target rect
+static bool CanTouchFromSurface(const ReachSurface *surface, Rectangle target, float playerSize)
+{
+    float launchSpeed = GetStepLaunchSpeed(PLAYER_JUMP_SPD);
+    float apex = launchSpeed*launchSpeed/(2.0f*G);
+    bool horizontal = (surface->left < target.x + target.width + playerSize/2.0f) && (surface->right > target.x - playerSize/2.0f);
+    bool vertical = (surface->y > target.y) && (surface->y - apex < target.y + target.height + playerSize);
+
+    return horizontal && vertical;
+}
+
+static unsigned char *BuildTargetTable(const ReachGraph *graph, const Rectangle *targets, int qtdTargets, float playerSize)
+{
+    int n = graph->qtdSurfaces;
+    unsigned char *table = (unsigned char *)calloc((n > 0 && qtdTargets > 0)? n*qtdTargets : 1, 1);
+
+    for (int t = 0; t < qtdTargets; t++)
+    {
+        for (int s = 0; s < n; s++)
+        {
+            if (!CanTouchFromSurface(&graph->surfaces[s], targets[t], playerSize)) continue;
+
+            for (int from = 0; from < n; from++)
+            {
+                if (graph->reachable[from*n + s]) table[from*qtdTargets + t] = 1;
+            }
+        }
+    }
+
+    return table;
+}
+
+//----------------------------------------------------------------------------------
+// Public API
+//----------------------------------------------------------------------------------
+// Moving platforms are left out, their reachability depends on timing
+void BuildLevelReach(struct Level *map, Vector2 spawn, float playerSize)
+{
+    ReachGraph *graph = &map->reach;
+    const EntityStore *store = &map->entities;
+    int qtdColliders = CountComponents(store, COMPONENT_COLLIDER);
+    int n = 0;
+
+    graph->surfaces = (ReachSurface *)malloc((qtdColliders > 0? qtdColliders : 1)*sizeof(ReachSurface));
+
+    EntityQuery query = QueryEntities(store, COMPONENT_BIT(COMPONENT_COLLIDER) | COMPONENT_BIT(COMPONENT_TRANSFORM), 0);
+    while (NextEntity(&query))
+    {
+        const Rectangle *rect = GetEntityRect(store, query.entity);
+        const Mover *mover = GetEntityMover(store, query.entity);
+
+        if ((mover == NULL) || (mover->period <= 0.0f))
+        {
+            graph->surfaces[n++] = (ReachSurface){rect->x, rect->x + rect->width, rect->y, query.entity};
+        }
+    }
+
+    graph->qtdSurfaces = n;
+    graph->edges = (unsigned char *)calloc((n > 0)? n*n : 1, 1);
+    graph->reachable = (unsigned char *)calloc((n > 0)? n*n : 1, 1);
+
+    ReachEvent *events = (ReachEvent *)malloc((n + 1)*sizeof(ReachEvent));
+    ReachSpan *spans = (ReachSpan *)malloc((n + 3)*sizeof(ReachSpan));
+    ReachSpan *scratch = (ReachSpan *)malloc((n + 3)*sizeof(ReachSpan));
+    int *queue = (int *)malloc((n + 1)*sizeof(int));
+
+    for (int from = 0; from < n; from++)
+    {
+        TraceReachArcs(graph, from, PLAYER_JUMP_SPD, events, spans, scratch);
+        TraceReachArcs(graph, from, 0.0f, events, spans, scratch);
+    }
+
+    // Transitive closure, one breadth first search per surface
+    for (int from = 0; from < n; from++)
+    {
+        unsigned char *row = &graph->reachable[from*n];
+        int head = 0;
+        int tail = 0;
+
+        row[from] = 1;
+        queue[tail++] = from;
+
+        while (head < tail)
+        {
+            int current = queue[head++];
+
+            for (int to = 0; to < n; to++)
+            {
+                if (graph->edges[current*n + to] && !row[to])
+                {
+                    row[to] = 1;
+                    queue[tail++] = to;
+                }
+            }
+        }
+    }
+
+    // Goals and spawners are numbered by their index in the component arrays
+    int qtdGoals = CountComponents(store, COMPONENT_GOAL);
+    int qtdSpawners = CountComponents(store, COMPONENT_SPAWNER);
+    int qtdTargets = (qtdGoals > qtdSpawners)? qtdGoals : qtdSpawners;
+    Rectangle *targets = (Rectangle *)malloc((qtdTargets > 0? qtdTargets : 1)*sizeof(Rectangle));
+
+    for (int i = 0; i < qtdGoals; i++) targets[i] = *GetEntityRect(store, GetComponentOwner(store, COMPONENT_GOAL, i));
+    graph->qtdGoals = qtdGoals;
+    graph->goals = BuildTargetTable(graph, targets, qtdGoals, playerSize);
+
+    for (int i = 0; i < qtdSpawners; i++) targets[i] = *GetEntityRect(store, GetComponentOwner(store, COMPONENT_SPAWNER, i));
+    graph->qtdSpawners = qtdSpawners;
+    graph->spawners = BuildTargetTable(graph, targets, qtdSpawners, playerSize);
+
+    free(events);
+    free(spans);
+    free(scratch);
+    free(queue);
+    free(targets);
+    graph->startSurface = FindReachSurface(graph, spawn);
+
+    // Level validation
+    if (graph->startSurface == -1) TraceLog(LOG_WARNING, "LEVEL %i: Player spawn is not above any platform", map->id);
+
+    for (int i = 0; i < qtdGoals; i++)
+    {
+        if (!IsGoalReachable(graph, graph->startSurface, i)) TraceLog(LOG_WARNING, "LEVEL %i: Goal %i can not be reached", map->id, i);
+    }
+
+    for (int i = 0; i < qtdSpawners; i++)
+    {
+        if (!IsSpawnerReachable(graph, graph->startSurface, i)) TraceLog(LOG_WARNING, "LEVEL %i: Spawner %i can not be reached", map->id, i);
+    }
+}
+
+void UnloadReachGraph(ReachGraph *graph)
+{
+    free(graph->surfaces);
+    free(graph->edges);
+    free(graph->reachable);
+    free(graph->goals);
+    free(graph->spawners);
+    memset(graph, 0, sizeof(ReachGraph));
+}
+
+// Surface the player stands on or would fall onto from position, -1 if none
+int FindReachSurface(const ReachGraph *graph, Vector2 position)
+{
+    int result = -1;
+
+    for (int i = 0; i < graph->qtdSurfaces; i++)
+    {
+        const ReachSurface *surface = &graph->surfaces[i];
+
+        if ((surface->left <= position.x) && (position.x <= surface->right) && (surface->y >= position.y) &&
+            ((result == -1) || (surface->y < graph->surfaces[result].y))) result = i;
+    }
+
+    return result;
+}
+
+bool IsSurfaceReachable(const ReachGraph *graph, int from, int to)
+{
+    if ((from < 0) || (to < 0)) return false;
+
+    return graph->reachable[from*graph->qtdSurfaces + to];
+}
+
+bool IsGoalReachable(const ReachGraph *graph, int from, int goal)
+{
+    if (from < 0) return false;
+
+    return graph->goals[from*graph->qtdGoals + goal];
+}
+
+bool IsSpawnerReachable(const ReachGraph *graph, int from, int spawner)
+{
+    if (from < 0) return false;
+
+    return graph->spawners[from*graph->qtdSpawners + spawner];
+}
+
+// Debug overlay, surfaces reachable from the given one are drawn in green
+void DrawReachGraph(const ReachGraph *graph, int from)
+{
+    int n = graph->qtdSurfaces;
+
+    for (int i = 0; i < n; i++)
+    {
+        const ReachSurface *a = &graph->surfaces[i];
+        Vector2 centerA = {(a->left + a->right)/2.0f, a->y};
+
+        for (int j = 0; j < n; j++)
+        {
+            if (!graph->edges[i*n + j]) continue;
+
+            const ReachSurface *b = &graph->surfaces[j];
+            DrawLineV(centerA, (Vector2){(b->left + b->right)/2.0f, b->y}, Fade(DARKBLUE, 0.4f));
+        }
+
+        Color color = IsSurfaceReachable(graph, from, i)? LIME : MAROON;
+        DrawLineEx((Vector2){a->left, a->y}, (Vector2){a->right, a->y}, 3.0f, color);
+        DrawCircleV(centerA, 4.0f, (i == from)? GOLD : color);
+    }
+}
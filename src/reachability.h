@@ -0,0 +1,43 @@
+#ifndef reachability // guardas de cabeçalho, impedem inclusões cíclicas
+#define reachability
+
+#include "raylib.h"
+
+#define REACH_STEP_TIME (1.0f/60.0f)   // Physics step of the game at its target frame rate, the arcs follow it
+
+// Top of a static collider the player can stand on
+typedef struct ReachSurface
+{
+    float left;
+    float right;
+    float y;
+    int entity;
+} ReachSurface;
+
+// Which surfaces can be reached from which, built once per level from the player physics
+typedef struct ReachGraph
+{
+    int qtdSurfaces;
+    ReachSurface *surfaces;
+    unsigned char *edges;      // [from*qtdSurfaces + to], a single jump or fall
+    unsigned char *reachable;  // [from*qtdSurfaces + to], any sequence of jumps and falls
+    int qtdGoals;
+    unsigned char *goals;      // [from*qtdGoals + goal], goal can be touched after leaving from
+    int qtdSpawners;
+    unsigned char *spawners;   // [from*qtdSpawners + spawner]
+    int startSurface;          // Where the player lands after spawning, -1 if it falls out of the level
+} ReachGraph;
+
+struct Level; // Defined in level.h, which stores the graph
+
+void BuildLevelReach(struct Level *map, Vector2 spawn, float playerSize);
+void UnloadReachGraph(ReachGraph *graph);
+
+int FindReachSurface(const ReachGraph *graph, Vector2 position);
+bool IsSurfaceReachable(const ReachGraph *graph, int from, int to);
+bool IsGoalReachable(const ReachGraph *graph, int from, int goal);
+bool IsSpawnerReachable(const ReachGraph *graph, int from, int spawner);
+
+void DrawReachGraph(const ReachGraph *graph, int from);
+
+#endif
@@ -5,7 +5,6 @@
 #include "level.h"
 
 #include <math.h>
-#include <stdio.h>
 #include <stdbool.h>
 
 bool CheckLineRecColision(Line line, Rectangle rec, LineRecColisions *collisionPoints)
@@ -22,79 +21,190 @@ bool CheckLineRecColision(Line line, Rectangle rec, LineRecColisions *collisionP
    colision = colision || CheckCollisionLines(line.start, line.end, (Vector2){recX1, recY1}, (Vector2){recX2, recY1}, &collisionPoints->topColisionPoint);
    colision = colision || CheckCollisionLines(line.start, line.end, (Vector2){recX1, recY2}, (Vector2){recX2, recY2}, &collisionPoints->bottomColisionPoint);
 
-   printf("colision = %d\n", colision);
-
    return colision;
 }
 
-bool CheckLineEnvColision(Line line, EnvItem *envItems, int qtdEnvItems, LineRecColisions *collisionPoints)
+typedef struct LineLevelQuery
 {
-   bool colision = false;
+   const EntityStore *entities;
+   bool colision;
+} LineLevelQuery;
 
-   for (int i = 0; i < qtdEnvItems; i++)
+static float LineLevelQueryCallback(Vector2 start, Vector2 end, float maxFraction, int userData, void *context)
+{
+   LineLevelQuery *query = (LineLevelQuery *)context;
+   LineRecColisions colisions;
+
+   if (CheckLineRecColision((Line){start, end}, *GetEntityRect(query->entities, userData), &colisions))
    {
-      if (envItems[i].blocking)
-      {
-         colision = colision || CheckLineRecColision(line, envItems[i].rect, collisionPoints);
-      }
+      query->colision = true;
+      return 0.0f;
    }
 
-   return colision;
+   return maxFraction;
 }
 
-Vector2 GetLineEnvItemClosestColisionVector2(Line line, EnvItem *envItems, int qtdEnvItems)
+// Only the colliders whose tree boxes the line crosses are checked
+bool CheckLineLevelColision(Line line, const Level *map)
 {
-   Vector2 lineEndPoint = line.end;
+   LineLevelQuery query = {&map->entities, false};
+
+   AabbTreeQuerySegment(&map->envTree, line.start, line.end, LineLevelQueryCallback, &query);
+
+   return query.colision;
+}
 
-   for (int i = 0; i < qtdEnvItems; i++)
+// Entry and exit crossings of the line with the rect border, in order of t, returns how many (0 to 2)
+int GetLineRecHits(Line line, Rectangle rec, LineHit *hits)
+{
+   float delta[2] = {line.end.x - line.start.x, line.end.y - line.start.y};
+   float origin[2] = {line.start.x, line.start.y};
+   float recMin[2] = {rec.x, rec.y};
+   float recMax[2] = {rec.x + rec.width, rec.y + rec.height};
+   float tEnter = -INFINITY;
+   float tExit = INFINITY;
+   Vector2 enterNormal = {0};
+   Vector2 exitNormal = {0};
+
+   for (int axis = 0; axis < 2; axis++)
    {
-      if (envItems[i].blocking)
+      if (fabsf(delta[axis]) < 1e-9f)
+      {
+         if ((origin[axis] < recMin[axis]) || (origin[axis] > recMax[axis])) return 0;
+         continue;
+      }
+
+      float t1 = (recMin[axis] - origin[axis])/delta[axis];
+      float t2 = (recMax[axis] - origin[axis])/delta[axis];
+      float sign = (delta[axis] > 0.0f)? 1.0f : -1.0f;
+
+      if (t1 > t2)
+      {
+         float swap = t1;
+         t1 = t2;
+         t2 = swap;
+      }
+
+      if (t1 > tEnter)
       {
-         Rectangle rec = envItems[i].rect;
-         LineRecColisions colisions;
-
-         if (CheckLineRecColision(line, rec, &colisions))
-         {
-            printf("leftColisionPoint = (%f, %f)\n", colisions.leftColisionPoint.x, colisions.leftColisionPoint.y);
-            printf("rightColisionPoint = (%f, %f)\n", colisions.rightColisionPoint.x, colisions.rightColisionPoint.y);
-            printf("topColisionPoint = (%f, %f)\n", colisions.topColisionPoint.x, colisions.topColisionPoint.y);
-            printf("bottomColisionPoint = (%f, %f)\n", colisions.bottomColisionPoint.x, colisions.bottomColisionPoint.y);
-
-            float leftDistance = Vector2Distance(line.start, colisions.leftColisionPoint);
-            float rightDistance = Vector2Distance(line.start, colisions.rightColisionPoint);
-            float topDistance = Vector2Distance(line.start, colisions.topColisionPoint);
-            float bottomDistance = Vector2Distance(line.start, colisions.bottomColisionPoint);
-
-            float minDistance1 = fminf(leftDistance, rightDistance);
-            float minDistance2 = fminf(topDistance, bottomDistance);
-            float minDistance = fminf(minDistance1, minDistance2);
-
-            if (minDistance < Vector2Distance(line.start, lineEndPoint))
-            {
-               if (FloatEquals(minDistance, leftDistance))
-               {
-                  printf("left\n");
-                  lineEndPoint = colisions.leftColisionPoint;
-               }
-               else if (FloatEquals(minDistance, rightDistance))
-               {
-                  printf("right\n");
-                  lineEndPoint = colisions.rightColisionPoint;
-               }
-               else if (FloatEquals(minDistance, topDistance))
-               {
-                  printf("top\n");
-                  lineEndPoint = colisions.topColisionPoint;
-               }
-               else if (FloatEquals(minDistance, bottomDistance))
-               {
-                  printf("bottom\n");
-                  lineEndPoint = colisions.bottomColisionPoint;
-               }
-            }
-         }
+         tEnter = t1;
+         enterNormal = (axis == 0)? (Vector2){-sign, 0.0f} : (Vector2){0.0f, -sign};
+      }
+
+      if (t2 < tExit)
+      {
+         tExit = t2;
+         exitNormal = (axis == 0)? (Vector2){sign, 0.0f} : (Vector2){0.0f, sign};
       }
    }
 
-   return lineEndPoint;
-}
\ No newline at end of file
+   if (tEnter > tExit) return 0;
+
+   int count = 0;
+
+   if ((tEnter >= 0.0f) && (tEnter <= 1.0f))
+   {
+      hits[count++] = (LineHit){tEnter, Vector2Lerp(line.start, line.end, tEnter), enterNormal, -1, true};
+   }
+
+   if ((tExit >= 0.0f) && (tExit <= 1.0f) && (tExit > tEnter))
+   {
+      hits[count++] = (LineHit){tExit, Vector2Lerp(line.start, line.end, tExit), exitNormal, -1, false};
+   }
+
+   return count;
+}
+
+typedef struct LineHitsQuery
+{
+   const EntityStore *entities;
+   LineHit *hits;
+   int qtdHits;
+   int maxHits;
+} LineHitsQuery;
+
+static float LineHitsQueryCallback(Vector2 start, Vector2 end, float maxFraction, int userData, void *context)
+{
+   LineHitsQuery *query = (LineHitsQuery *)context;
+   LineHit recHits[2];
+
+   int count = GetLineRecHits((Line){start, end}, *GetEntityRect(query->entities, userData), recHits);
+
+   for (int i = 0; i < count; i++)
+   {
+      // Insertion keeps the maxHits closest ones sorted by t
+      int slot = query->qtdHits;
+      while ((slot > 0) && (query->hits[slot - 1].t > recHits[i].t)) slot--;
+      if (slot >= query->maxHits) continue;
+
+      int last = (query->qtdHits < query->maxHits)? query->qtdHits : query->maxHits - 1;
+      for (int k = last; k > slot; k--) query->hits[k] = query->hits[k - 1];
+
+      recHits[i].entity = userData;
+      query->hits[slot] = recHits[i];
+      if (query->qtdHits < query->maxHits) query->qtdHits++;
+   }
+
+   // Once the buffer is full nothing past its farthest hit can make it in
+   return (query->qtdHits == query->maxHits)? fminf(maxFraction, query->hits[query->qtdHits - 1].t) : maxFraction;
+}
+
+// Every border crossing with a collider along the line, sorted by t, returns how many were written
+int GetLineLevelHits(Line line, const Level *map, LineHit *hits, int maxHits)
+{
+   LineHitsQuery query = {&map->entities, hits, 0, maxHits};
+
+   if (maxHits <= 0) return 0;
+
+   AabbTreeQuerySegment(&map->envTree, line.start, line.end, LineHitsQueryCallback, &query);
+
+   return query.qtdHits;
+}
+
+typedef struct ClosestHitQuery
+{
+   const EntityStore *entities;
+   LineHit hit;
+   bool found;
+} ClosestHitQuery;
+
+static float ClosestHitQueryCallback(Vector2 start, Vector2 end, float maxFraction, int userData, void *context)
+{
+   ClosestHitQuery *query = (ClosestHitQuery *)context;
+   LineHit recHits[2];
+
+   int count = GetLineRecHits((Line){start, end}, *GetEntityRect(query->entities, userData), recHits);
+
+   // Only entries count, a line starting inside an item does not hit it
+   if ((count > 0) && recHits[0].entering && (recHits[0].t <= maxFraction))
+   {
+      query->hit = recHits[0];
+      query->hit.entity = userData;
+      query->found = true;
+
+      // Clipping the line prunes every tree node behind this hit
+      return (recHits[0].t > 0.0f)? recHits[0].t : 0.0f;
+   }
+
+   return maxFraction;
+}
+
+// First collider entered by the line
+bool GetLineLevelClosestHit(Line line, const Level *map, LineHit *hit)
+{
+   ClosestHitQuery query = {&map->entities, {0}, false};
+
+   AabbTreeQuerySegment(&map->envTree, line.start, line.end, ClosestHitQueryCallback, &query);
+
+   if (query.found && (hit != NULL)) *hit = query.hit;
+
+   return query.found;
+}
+
+// Line end clamped to the first collider it enters
+Vector2 GetLineLevelClosestColisionVector2(Line line, const Level *map)
+{
+   LineHit hit;
+
+   return GetLineLevelClosestHit(line, map, &hit)? hit.point : line.end;
+}
@@ -20,9 +20,21 @@ typedef struct LineRecColisions
     Vector2 bottomColisionPoint;
 } LineRecColisions;
 
+// Point where a line crosses the border of a collider
+typedef struct LineHit
+{
+    float t;        // Fraction of the line, 0 at start and 1 at end
+    Vector2 point;
+    Vector2 normal; // Outward normal of the crossed side
+    int entity;
+    bool entering;  // false when the line leaves the item
+} LineHit;
+
 bool CheckLineRecColision(Line line, Rectangle rec, LineRecColisions *collisionPoints);
-bool CheckLineEnvColision(Line line, EnvItem *envItems, int qtdEnvItems, LineRecColisions *collisionPoints);
-Vector2 GetLineEnvItemClosestColisionVector2(Line line, EnvItem *envItems, int qtdEnvItems);
-bool lineLine(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, Vector2 *intersectionPoint);
+bool CheckLineLevelColision(Line line, const Level *map);
+Vector2 GetLineLevelClosestColisionVector2(Line line, const Level *map);
+int GetLineRecHits(Line line, Rectangle rec, LineHit *hits);
+int GetLineLevelHits(Line line, const Level *map, LineHit *hits, int maxHits);
+bool GetLineLevelClosestHit(Line line, const Level *map, LineHit *hit);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include "raylib.h"
+
+#include "sim_batch.h"
+#include "player.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_OPENMP)
+    #include <omp.h>
+#endif
+
+void InitSimBatch(SimBatch *batch, const Level *map, int count, Vector2 spawn, int maxSteps)
+{
+    int qtdGoals = CountComponents(&map->entities, COMPONENT_GOAL);
+    int qtdSpawners = CountComponents(&map->entities, COMPONENT_SPAWNER);
+
+    batch->count = count;
+    batch->map = map;
+    batch->spawn = spawn;
+    batch->maxSteps = maxSteps;
+    batch->obsSize = SIM_OBS_PLAYER + qtdGoals + qtdSpawners;
+
+    batch->positionX = (float *)malloc(count*sizeof(float));
+    batch->positionY = (float *)malloc(count*sizeof(float));
+    batch->speed = (float *)malloc(count*sizeof(float));
+    batch->canJump = (unsigned char *)malloc(count);
+    batch->groundItem = (int *)malloc(count*sizeof(int));
+    batch->steps = (int *)malloc(count*sizeof(int));
+    batch->progress = (GameProgress *)malloc(count*sizeof(GameProgress));
+
+    batch->move = (signed char *)calloc(count, 1);
+    batch->jump = (unsigned char *)calloc(count, 1);
+    batch->interact = (unsigned char *)calloc(count, 1);
+    batch->create = (unsigned char *)calloc(count, 1);
+    batch->clear = (unsigned char *)calloc(count, 1);
+
+    batch->observations = (float *)malloc(count*batch->obsSize*sizeof(float));
+    batch->rewards = (float *)malloc(count*sizeof(float));
+    batch->dones = (unsigned char *)malloc(count);
+
+    ResetSimBatch(batch);
+}
+
+void UnloadSimBatch(SimBatch *batch)
+{
+    free(batch->positionX);
+    free(batch->positionY);
+    free(batch->speed);
+    free(batch->canJump);
+    free(batch->groundItem);
+    free(batch->steps);
+    free(batch->progress);
+    free(batch->move);
+    free(batch->jump);
+    free(batch->interact);
+    free(batch->create);
+    free(batch->clear);
+    free(batch->observations);
+    free(batch->rewards);
+    free(batch->dones);
+    memset(batch, 0, sizeof(SimBatch));
+}
+
+GameState GetSimBatchState(const SimBatch *batch, int index)
+{
+    GameState state = {0};
+
+    state.position = (Vector2){batch->positionX[index], batch->positionY[index]};
+    state.speed = batch->speed[index];
+    state.canJump = batch->canJump[index];
+    state.groundItem = batch->groundItem[index];
+    state.steps = batch->steps[index];
+    state.progress = batch->progress[index];
+
+    return state;
+}
+
+void SetSimBatchState(SimBatch *batch, int index, GameState state)
+{
+    batch->positionX[index] = state.position.x;
+    batch->positionY[index] = state.position.y;
+    batch->speed[index] = state.speed;
+    batch->canJump[index] = state.canJump;
+    batch->groundItem[index] = state.groundItem;
+    batch->steps[index] = state.steps;
+    batch->progress[index] = state.progress;
+}
+
+// Positions are scaled to the level bounds, everything else to 0..1
+static void WriteObservation(SimBatch *batch, int index)
+{
+    const Rectangle bounds = batch->map->bounds;
+    const GameProgress *progress = &batch->progress[index];
+    float *obs = &batch->observations[index*batch->obsSize];
+    int qtdGoals = CountComponents(&batch->map->entities, COMPONENT_GOAL);
+    int qtdFlags = batch->obsSize - SIM_OBS_PLAYER;
+
+    obs[0] = (batch->positionX[index] - bounds.x)/bounds.width;
+    obs[1] = (batch->positionY[index] - bounds.y)/bounds.height;
+    obs[2] = batch->speed[index]/PLAYER_JUMP_SPD;
+    obs[3] = batch->canJump[index];
+    obs[4] = progress->selectedColor/3.0f;
+    obs[5] = (qtdGoals > 0)? (float)progress->qtdGoalsRemaining/qtdGoals : 0.0f;
+    for (int l = 0; l < GAME_LINES; l++) obs[6 + l] = (float)progress->qtdAnchors[l]/GAME_MAX_ANCHORS;
+
+    for (int i = 0; i < qtdFlags; i++)
+    {
+        unsigned int mask = (i < qtdGoals)? progress->goalsSet : progress->spawnersActive;
+        int bit = (i < qtdGoals)? i : i - qtdGoals;
+
+        obs[SIM_OBS_PLAYER + i] = (mask >> bit) & 1u;
+    }
+}
+
+static void ResetSimInstance(SimBatch *batch, int index)
+{
+    SetSimBatchState(batch, index, InitGameState(batch->map, batch->spawn));
+    batch->rewards[index] = 0.0f;
+    batch->dones[index] = 0;
+    WriteObservation(batch, index);
+}
+
+void ResetSimBatch(SimBatch *batch)
+{
+    for (int i = 0; i < batch->count; i++) ResetSimInstance(batch, i);
+}
+
+static void StepSimInstance(SimBatch *batch, int index)
+{
+    const Level *map = batch->map;
+    float reward = 0.0f;
+
+    if (batch->dones[index]) ResetSimInstance(batch, index);
+
+    Vector2 position = {batch->positionX[index], batch->positionY[index]};
+
+    // Most steps carry no action, the progress struct is only touched when one does
+    if (batch->interact[index] || batch->create[index] || batch->clear[index] || (batch->progress[index].spawnersActive != 0))
+    {
+        GameInput input = {batch->move[index], batch->jump[index], batch->interact[index], batch->create[index], batch->clear[index]};
+
+        reward = (float)ApplyGameInput(&batch->progress[index], map, GetPlayerRect(position), input, NULL);
+    }
+
+    float speed = batch->speed[index];
+    bool canJump = batch->canJump[index];
+    int groundItem = batch->groundItem[index];
+
+    StepPlayerBody(map, &position, &speed, &canJump, &groundItem, batch->move[index], batch->jump[index], SIM_STEP_TIME);
+
+    batch->positionX[index] = position.x;
+    batch->positionY[index] = position.y;
+    batch->speed[index] = speed;
+    batch->canJump[index] = canJump;
+    batch->groundItem[index] = groundItem;
+    batch->steps[index]++;
+    batch->rewards[index] = reward;
+    batch->dones[index] = (batch->progress[index].qtdGoalsRemaining == 0) ||
+                          (position.y > map->bounds.y + map->bounds.height) ||
+                          ((batch->maxSteps > 0) && (batch->steps[index] >= batch->maxSteps));
+
+    WriteObservation(batch, index);
+}
+
+void StepSimBatch(SimBatch *batch)
+{
+    // Instances only share the read only level, static chunks keep each core on its own cache lines
+#if defined(_OPENMP)
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int i = 0; i < batch->count; i++) StepSimInstance(batch, i);
+}
+
+static double GetWallTime(void)
+{
+#if defined(_OPENMP)
+    return omp_get_wtime();
+#else
+    return (double)clock()/CLOCKS_PER_SEC;   // Single threaded, CPU time is close enough
+#endif
+}
+
+double BenchmarkSimBatch(const Level *map, Vector2 spawn, int count, int steps)
+{
+    SimBatch batch = {0};
+
+    InitSimBatch(&batch, map, count, spawn, 600);
+
+    double start = GetWallTime();
+
+    for (int s = 0; s < steps; s++)
+    {
+#if defined(_OPENMP)
+        #pragma omp parallel for schedule(static)
+#endif
+        for (int i = 0; i < count; i++)
+        {
+            // xorshift on the instance and step, no shared generator between threads
+            unsigned int x = (unsigned int)(i*2654435761u) ^ (unsigned int)(s*40503u + 1u);
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+
+            batch.move[i] = (signed char)((int)(x%3u) - 1);
+            batch.jump[i] = ((x >> 4)%8u) == 0;
+            batch.interact[i] = ((x >> 8)%16u) == 0;
+            batch.create[i] = ((x >> 12)%32u) == 0;
+            batch.clear[i] = ((x >> 16)%128u) == 0;
+        }
+
+        StepSimBatch(&batch);
+    }
+
+    double elapsed = GetWallTime() - start;
+
+    UnloadSimBatch(&batch);
+
+    return (elapsed > 0.0)? (double)count*steps/elapsed : 0.0;
+}
@@ -0,0 +1,55 @@
+#ifndef sim_batch // guardas de cabeçalho, impedem inclusões cíclicas
+#define sim_batch
+
+#include "raylib.h"
+
+#include "level.h"
+#include "game_state.h"
+
+#define SIM_STEP_TIME (1.0f/60.0f)
+#define SIM_OBS_PLAYER 9    // Observation values before the goal and spawner flags
+
+// Many headless instances of the same level stepped together. Player bodies and
+// actions are kept as one array per field, the rarely touched progress as one struct
+// per instance. Instances that finish are reset at the start of the next step.
+typedef struct SimBatch
+{
+    int count;
+    const Level *map;       // Shared and read only, movers stay where they are
+    Vector2 spawn;
+    int maxSteps;           // Episode length, 0 for no limit
+
+    // Player bodies
+    float *positionX;
+    float *positionY;
+    float *speed;
+    unsigned char *canJump;
+    int *groundItem;
+    int *steps;
+    GameProgress *progress;
+
+    // Actions, written by the caller before every step
+    signed char *move;
+    unsigned char *jump;
+    unsigned char *interact;
+    unsigned char *create;
+    unsigned char *clear;
+
+    // Results of the last step
+    int obsSize;
+    float *observations;    // [instance*obsSize + value]
+    float *rewards;         // Goals set on the step
+    unsigned char *dones;   // Every goal set, left the level or ran out of steps
+} SimBatch;
+
+void InitSimBatch(SimBatch *batch, const Level *map, int count, Vector2 spawn, int maxSteps);
+void UnloadSimBatch(SimBatch *batch);
+void ResetSimBatch(SimBatch *batch);
+// Steps every instance by SIM_STEP_TIME, spread over the cores when built with OpenMP
+void StepSimBatch(SimBatch *batch);
+GameState GetSimBatchState(const SimBatch *batch, int index);
+void SetSimBatchState(SimBatch *batch, int index, GameState state);
+// Steps count instances with random actions, returns instance steps per second
+double BenchmarkSimBatch(const Level *map, Vector2 spawn, int count, int steps);
+
+#endif
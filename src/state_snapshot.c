@@ -0,0 +1,213 @@
+#include "raylib.h"
+
+#include "state_snapshot.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------------
+// Shared parts
+//----------------------------------------------------------------------------------
+static void ReleaseAnchors(AnchorNode *node)
+{
+    while ((node != NULL) && (--node->refCount == 0))
+    {
+        AnchorNode *previous = node->previous;
+        free(node);
+        node = previous;
+    }
+}
+
+static AnchorNode *RetainAnchors(AnchorNode *node)
+{
+    if (node != NULL) node->refCount++;
+
+    return node;
+}
+
+// Strings only grow between actions or go back to a prefix (undo, restart),
+// so the new list reuses the common prefix of the previous one
+static StringSnapshot CaptureString(StringSnapshot previous, const Vector2 *anchors, int count, bool connected)
+{
+    StringSnapshot result = {0};
+    AnchorNode *tail = previous.tail;
+    int shared = previous.count;
+
+    while (shared > count)
+    {
+        tail = tail->previous;
+        shared--;
+    }
+
+    RetainAnchors(tail);
+
+    for (int i = shared; i < count; i++)
+    {
+        AnchorNode *node = (AnchorNode *)malloc(sizeof(AnchorNode));
+        node->refCount = 1;
+        node->point = anchors[i];
+        node->previous = tail; // Takes over the reference held by tail
+        tail = node;
+    }
+
+    result.tail = tail;
+    result.count = count;
+    result.connected = connected;
+
+    return result;
+}
+
+static GameSnapshot CopySnapshot(const GameSnapshot *snapshot)
+{
+    GameSnapshot copy = *snapshot;
+
+    for (int i = 0; i < GAME_LINES; i++) RetainAnchors(copy.lines[i].tail);
+
+    return copy;
+}
+
+static void ReleaseSnapshot(GameSnapshot *snapshot)
+{
+    for (int i = 0; i < GAME_LINES; i++) ReleaseAnchors(snapshot->lines[i].tail);
+}
+
+static void AppendSnapshot(SnapshotHistory *history, GameSnapshot snapshot)
+{
+    // A new action discards whatever could still be redone
+    while (history->count > history->cursor + 1) ReleaseSnapshot(&history->snapshots[--history->count]);
+
+    if (history->count == history->capacity)
+    {
+        history->capacity = (history->capacity == 0)? 32 : history->capacity*2;
+        history->snapshots = (GameSnapshot *)realloc(history->snapshots, history->capacity*sizeof(GameSnapshot));
+    }
+
+    history->snapshots[history->count] = snapshot;
+    history->cursor = history->count;
+    history->count++;
+}
+
+//----------------------------------------------------------------------------------
+// Public API
+//----------------------------------------------------------------------------------
+void InitSnapshotHistory(SnapshotHistory *history)
+{
+    history->snapshots = NULL;
+    history->count = 0;
+    history->capacity = 0;
+    history->cursor = -1;
+}
+
+void UnloadSnapshotHistory(SnapshotHistory *history)
+{
+    for (int i = 0; i < history->count; i++) ReleaseSnapshot(&history->snapshots[i]);
+    free(history->snapshots);
+    InitSnapshotHistory(history);
+}
+
+void ResetSnapshotHistory(SnapshotHistory *history, const GameState *state)
+{
+    for (int i = 0; i < history->count; i++) ReleaseSnapshot(&history->snapshots[i]);
+    history->count = 0;
+    history->cursor = -1;
+
+    PushSnapshot(history, state, SNAPSHOT_ALL);
+}
+
+void PushSnapshot(SnapshotHistory *history, const GameState *state, unsigned int changes)
+{
+    const GameProgress *progress = &state->progress;
+    GameSnapshot snapshot = {0};
+
+    if (history->cursor >= 0) snapshot = CopySnapshot(&history->snapshots[history->cursor]);
+    else changes = SNAPSHOT_ALL;
+
+    snapshot.position = state->position;
+    snapshot.selectedColor = progress->selectedColor;
+    snapshot.goalsSet = progress->goalsSet;
+    snapshot.spawnersActive = progress->spawnersActive;
+    snapshot.qtdGoalsRemaining = progress->qtdGoalsRemaining;
+
+    if (changes & SNAPSHOT_STRINGS)
+    {
+        for (int i = 0; i < GAME_LINES; i++)
+        {
+            StringSnapshot previous = snapshot.lines[i];
+            snapshot.lines[i] = CaptureString(previous, progress->anchors[i], progress->qtdAnchors[i], (progress->connected & (1u << i)) != 0);
+            ReleaseAnchors(previous.tail);
+        }
+    }
+
+    AppendSnapshot(history, snapshot);
+}
+
+unsigned int GetSnapshotChanges(const GameProgress *progress, const GameProgress *previous)
+{
+    unsigned int changes = 0;
+
+    if (progress->selectedColor != previous->selectedColor) changes |= SNAPSHOT_PLAYER;
+    if (progress->connected != previous->connected) changes |= SNAPSHOT_STRINGS;
+    if (progress->goalsSet != previous->goalsSet) changes |= SNAPSHOT_GOALS;
+    if (progress->spawnersActive != previous->spawnersActive) changes |= SNAPSHOT_SPAWNERS;
+
+    for (int i = 0; i < GAME_LINES; i++)
+    {
+        if (progress->qtdAnchors[i] != previous->qtdAnchors[i]) changes |= SNAPSHOT_STRINGS;
+    }
+
+    return changes;
+}
+
+const GameSnapshot *RestartSnapshot(SnapshotHistory *history)
+{
+    if (history->count == 0) return NULL;
+
+    AppendSnapshot(history, CopySnapshot(&history->snapshots[0]));
+
+    return &history->snapshots[history->cursor];
+}
+
+const GameSnapshot *UndoSnapshot(SnapshotHistory *history)
+{
+    if (history->cursor <= 0) return NULL;
+
+    history->cursor--;
+
+    return &history->snapshots[history->cursor];
+}
+
+const GameSnapshot *RedoSnapshot(SnapshotHistory *history)
+{
+    if (history->cursor + 1 >= history->count) return NULL;
+
+    history->cursor++;
+
+    return &history->snapshots[history->cursor];
+}
+
+// Writes the snapshot back into the game state, the caller rebuilds anything derived from the strings
+void ApplySnapshot(const GameSnapshot *snapshot, GameState *state)
+{
+    GameProgress *progress = &state->progress;
+
+    state->position = snapshot->position;
+    state->speed = 0.0f;
+    state->groundItem = ENTITY_NONE;
+    progress->selectedColor = snapshot->selectedColor;
+    progress->connected = 0;
+
+    for (int i = 0; i < GAME_LINES; i++)
+    {
+        const StringSnapshot *string = &snapshot->lines[i];
+
+        int index = string->count - 1;
+        for (const AnchorNode *node = string->tail; node != NULL; node = node->previous) progress->anchors[i][index--] = node->point;
+
+        progress->qtdAnchors[i] = string->count;
+        if (string->connected) progress->connected |= 1u << i;
+    }
+
+    progress->goalsSet = snapshot->goalsSet;
+    progress->spawnersActive = snapshot->spawnersActive;
+    progress->qtdGoalsRemaining = snapshot->qtdGoalsRemaining;
+}
@@ -0,0 +1,64 @@
+#ifndef state_snapshot // guardas de cabeçalho, impedem inclusões cíclicas
+#define state_snapshot
+
+#include "raylib.h"
+
+#include "game_state.h"
+
+// What changed since the previous snapshot, parts that did not change are shared
+#define SNAPSHOT_PLAYER    0x01
+#define SNAPSHOT_STRINGS   0x02
+#define SNAPSHOT_GOALS     0x04
+#define SNAPSHOT_SPAWNERS  0x08
+#define SNAPSHOT_ALL       0x0F
+
+// Immutable anchor, a string is a list from its last anchor back to the first one,
+// so snapshots of a growing string share every anchor they have in common
+typedef struct AnchorNode
+{
+    int refCount;
+    Vector2 point;
+    struct AnchorNode *previous;
+} AnchorNode;
+
+typedef struct StringSnapshot
+{
+    AnchorNode *tail;
+    int count;
+    bool connected;
+} StringSnapshot;
+
+// The goal and spawner flags are bit masks, copied whole into every snapshot
+typedef struct GameSnapshot
+{
+    Vector2 position;
+    int selectedColor;
+    StringSnapshot lines[GAME_LINES];
+    unsigned int goalsSet;
+    unsigned int spawnersActive;
+    int qtdGoalsRemaining;
+} GameSnapshot;
+
+// Undo/redo stack, snapshots[0] is the state at level load and snapshots past cursor can be redone
+typedef struct SnapshotHistory
+{
+    GameSnapshot *snapshots;
+    int count;
+    int capacity;
+    int cursor;
+} SnapshotHistory;
+
+void InitSnapshotHistory(SnapshotHistory *history);
+void UnloadSnapshotHistory(SnapshotHistory *history);
+// Drops every snapshot and takes the level load one from the current state
+void ResetSnapshotHistory(SnapshotHistory *history, const GameState *state);
+void PushSnapshot(SnapshotHistory *history, const GameState *state, unsigned int changes);
+// Snapshot parts that differ between two progresses, 0 when there is nothing to push
+unsigned int GetSnapshotChanges(const GameProgress *progress, const GameProgress *previous);
+// Pushes a copy of the level load snapshot, so restarting the level can be undone too
+const GameSnapshot *RestartSnapshot(SnapshotHistory *history);
+const GameSnapshot *UndoSnapshot(SnapshotHistory *history);
+const GameSnapshot *RedoSnapshot(SnapshotHistory *history);
+void ApplySnapshot(const GameSnapshot *snapshot, GameState *state);
+
+#endif
@@ -0,0 +1,292 @@
+#include "raylib.h"
+
+#include "string_crossing.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+//----------------------------------------------------------------------------------
+// Segment tests
+//----------------------------------------------------------------------------------
+static float Orientation(Vector2 a, Vector2 b, Vector2 c)
+{
+    return (b.x - a.x)*(c.y - a.y) - (b.y - a.y)*(c.x - a.x);
+}
+
+// p is known to be collinear with a-b
+static bool OnSegment(Vector2 a, Vector2 b, Vector2 p)
+{
+    return (fminf(a.x, b.x) <= p.x) && (p.x <= fmaxf(a.x, b.x)) &&
+           (fminf(a.y, b.y) <= p.y) && (p.y <= fmaxf(a.y, b.y));
+}
+
+// Touching counts as crossing, a string cannot rest on another one
+static bool SegmentsIntersect(Vector2 a, Vector2 b, Vector2 c, Vector2 d)
+{
+    float d1 = Orientation(c, d, a);
+    float d2 = Orientation(c, d, b);
+    float d3 = Orientation(a, b, c);
+    float d4 = Orientation(a, b, d);
+
+    if ((((d1 > 0.0f) && (d2 < 0.0f)) || ((d1 < 0.0f) && (d2 > 0.0f))) &&
+        (((d3 > 0.0f) && (d4 < 0.0f)) || ((d3 < 0.0f) && (d4 > 0.0f)))) return true;
+
+    if ((d1 == 0.0f) && OnSegment(c, d, a)) return true;
+    if ((d2 == 0.0f) && OnSegment(c, d, b)) return true;
+    if ((d3 == 0.0f) && OnSegment(a, b, c)) return true;
+    if ((d4 == 0.0f) && OnSegment(a, b, d)) return true;
+
+    return false;
+}
+
+// Consecutive segments of the same string share an anchor, they only cross when
+// the second one folds back over the first
+static bool NeighbourSegmentsFold(const StringSegment *a, const StringSegment *b)
+{
+    Vector2 shared = a->end;
+    Vector2 u = a->start;
+    Vector2 v = b->end;
+
+    if ((a->start.x == b->start.x && a->start.y == b->start.y) || (a->start.x == b->end.x && a->start.y == b->end.y))
+    {
+        shared = a->start;
+        u = a->end;
+    }
+    if (b->end.x == shared.x && b->end.y == shared.y) v = b->start;
+
+    return (Orientation(shared, u, v) == 0.0f) && ((u.x - shared.x)*(v.x - shared.x) + (u.y - shared.y)*(v.y - shared.y) > 0.0f);
+}
+
+bool StringSegmentsCross(const StringSegment *a, const StringSegment *b)
+{
+    if ((a->line == b->line) && (a->index == b->index)) return false;
+    if ((a->line == b->line) && (abs(a->index - b->index) == 1)) return NeighbourSegmentsFold(a, b);
+
+    return SegmentsIntersect(a->start, a->end, b->start, b->end);
+}
+
+static Rectangle SegmentBox(Vector2 start, Vector2 end)
+{
+    return (Rectangle){fminf(start.x, end.x), fminf(start.y, end.y), fabsf(end.x - start.x), fabsf(end.y - start.y)};
+}
+
+//----------------------------------------------------------------------------------
+// Incremental segment index
+//----------------------------------------------------------------------------------
+void InitStringIndex(StringIndex *index)
+{
+    InitAabbTree(&index->tree, 0.0f);
+    index->segments = NULL;
+    index->qtdSegments = 0;
+    index->capacity = 0;
+}
+
+void UnloadStringIndex(StringIndex *index)
+{
+    UnloadAabbTree(&index->tree);
+    free(index->segments);
+    InitStringIndex(index);
+}
+
+// Keeps the allocations around for the next strings
+void ClearStringIndex(StringIndex *index)
+{
+    ClearAabbTree(&index->tree);
+    index->qtdSegments = 0;
+}
+
+void AddStringSegment(StringIndex *index, Vector2 start, Vector2 end, int line, int segment)
+{
+    if (index->qtdSegments == index->capacity)
+    {
+        index->capacity = (index->capacity == 0)? 16 : index->capacity*2;
+        index->segments = (StringSegment *)realloc(index->segments, index->capacity*sizeof(StringSegment));
+    }
+
+    index->segments[index->qtdSegments] = (StringSegment){start, end, line, segment};
+    AabbTreeCreateProxy(&index->tree, SegmentBox(start, end), index->qtdSegments);
+    index->qtdSegments++;
+}
+
+void RebuildStringIndex(StringIndex *index, Points **lines, int qtdLines)
+{
+    ClearStringIndex(index);
+
+    for (int i = 0; i < qtdLines; i++)
+    {
+        for (int j = 0; j < lines[i]->last; j++)
+        {
+            AddStringSegment(index, lines[i]->points[j], lines[i]->points[j + 1], i + 1, j);
+        }
+    }
+}
+
+typedef struct CrossingQuery
+{
+    const StringSegment *segments;
+    StringSegment candidate;
+    bool crossing;
+} CrossingQuery;
+
+static float CrossingQueryCallback(Vector2 start, Vector2 end, float maxFraction, int userData, void *context)
+{
+    CrossingQuery *query = (CrossingQuery *)context;
+
+    if (StringSegmentsCross(&query->candidate, &query->segments[userData]))
+    {
+        query->crossing = true;
+        return 0.0f;
+    }
+
+    return maxFraction;
+}
+
+// Tests a segment about to be appended as segment number segment of line against every placed segment
+bool CheckStringSegmentCrossing(const StringIndex *index, Vector2 start, Vector2 end, int line, int segment)
+{
+    CrossingQuery query = {index->segments, {start, end, line, segment}, false};
+
+    AabbTreeQuerySegment(&index->tree, start, end, CrossingQueryCallback, &query);
+
+    return query.crossing;
+}
+
+//----------------------------------------------------------------------------------
+// Debug cross-check of StringIndex, only run in _DEBUG builds after the strings are restored.
+// Follows the Shamos-Hoey sweep line, but the active list is a sorted array, so shifting it on
+// insert and removal makes the worst case O(n^2) even though it takes O(n log n) comparisons.
+//----------------------------------------------------------------------------------
+typedef struct SweepEvent
+{
+    float x;
+    float y;
+    int segment;
+    int isEnd;
+} SweepEvent;
+
+static int CompareSweepEvents(const void *a, const void *b)
+{
+    const SweepEvent *ea = (const SweepEvent *)a;
+    const SweepEvent *eb = (const SweepEvent *)b;
+
+    if (ea->x != eb->x) return (ea->x < eb->x)? -1 : 1;
+    // Starts before ends at the same x, so segments touching there are active together
+    if (ea->isEnd != eb->isEnd) return ea->isEnd - eb->isEnd;
+    if (ea->y != eb->y) return (ea->y < eb->y)? -1 : 1;
+
+    return 0;
+}
+
+// Segments are stored left to right, vertical ones bottom to top
+static float SegmentYAt(const StringSegment *s, float x)
+{
+    float dx = s->end.x - s->start.x;
+
+    if (dx == 0.0f) return s->start.y;
+
+    return s->start.y + (s->end.y - s->start.y)*(x - s->start.x)/dx;
+}
+
+static float SegmentSlope(const StringSegment *s)
+{
+    float dx = s->end.x - s->start.x;
+
+    return (dx == 0.0f)? INFINITY : (s->end.y - s->start.y)/dx;
+}
+
+static bool SegmentIsBelow(const StringSegment *a, const StringSegment *b, float x)
+{
+    float ya = SegmentYAt(a, x);
+    float yb = SegmentYAt(b, x);
+
+    if (ya != yb) return ya < yb;
+
+    return SegmentSlope(a) < SegmentSlope(b);
+}
+
+bool FindStringsCrossing(Points **lines, int qtdLines, StringSegment *first, StringSegment *second)
+{
+    int qtdSegments = 0;
+    for (int i = 0; i < qtdLines; i++) qtdSegments += (lines[i]->last > 0)? lines[i]->last : 0;
+
+    if (qtdSegments < 2) return false;
+
+    StringSegment *segments = (StringSegment *)malloc(qtdSegments*sizeof(StringSegment));
+    SweepEvent *events = (SweepEvent *)malloc(2*qtdSegments*sizeof(SweepEvent));
+    int *active = (int *)malloc(qtdSegments*sizeof(int));
+    int qtdActive = 0;
+    int count = 0;
+
+    for (int i = 0; i < qtdLines; i++)
+    {
+        for (int j = 0; j < lines[i]->last; j++)
+        {
+            Vector2 a = lines[i]->points[j];
+            Vector2 b = lines[i]->points[j + 1];
+            bool swap = (b.x < a.x) || ((b.x == a.x) && (b.y < a.y));
+
+            segments[count] = (StringSegment){swap? b : a, swap? a : b, i + 1, j};
+            events[2*count] = (SweepEvent){segments[count].start.x, segments[count].start.y, count, 0};
+            events[2*count + 1] = (SweepEvent){segments[count].end.x, segments[count].end.y, count, 1};
+            count++;
+        }
+    }
+
+    qsort(events, 2*qtdSegments, sizeof(SweepEvent), CompareSweepEvents);
+
+    int crossA = -1;
+    int crossB = -1;
+
+    for (int e = 0; (e < 2*qtdSegments) && (crossA == -1); e++)
+    {
+        SweepEvent *event = &events[e];
+        const StringSegment *s = &segments[event->segment];
+
+        if (!event->isEnd)
+        {
+            // Binary search for the slot keeping the active list ordered by y at the sweep line
+            int low = 0;
+            int high = qtdActive;
+            while (low < high)
+            {
+                int mid = (low + high)/2;
+                if (SegmentIsBelow(&segments[active[mid]], s, event->x)) low = mid + 1;
+                else high = mid;
+            }
+
+            for (int k = qtdActive; k > low; k--) active[k] = active[k - 1];
+            active[low] = event->segment;
+            qtdActive++;
+
+            if ((low > 0) && StringSegmentsCross(s, &segments[active[low - 1]])) { crossA = event->segment; crossB = active[low - 1]; }
+            else if ((low + 1 < qtdActive) && StringSegmentsCross(s, &segments[active[low + 1]])) { crossA = event->segment; crossB = active[low + 1]; }
+        }
+        else
+        {
+            int slot = 0;
+            while ((slot < qtdActive) && (active[slot] != event->segment)) slot++;
+
+            for (int k = slot; k < qtdActive - 1; k++) active[k] = active[k + 1];
+            qtdActive--;
+
+            // The neighbours of the removed segment become adjacent
+            if ((slot > 0) && (slot < qtdActive) && StringSegmentsCross(&segments[active[slot - 1]], &segments[active[slot]]))
+            {
+                crossA = active[slot - 1];
+                crossB = active[slot];
+            }
+        }
+    }
+
+    if (crossA != -1)
+    {
+        if (first != NULL) *first = segments[crossA];
+        if (second != NULL) *second = segments[crossB];
+    }
+
+    free(segments);
+    free(events);
+    free(active);
+
+    return (crossA != -1);
+}
@@ -0,0 +1,41 @@
+#ifndef string_crossing // guardas de cabeçalho, impedem inclusões cíclicas
+#define string_crossing
+
+#include "raylib.h"
+
+#include "aabb_tree.h"
+#include "polyline.h"
+
+// Segment from points[index] to points[index + 1] of the string identified by line
+typedef struct StringSegment
+{
+    Vector2 start;
+    Vector2 end;
+    int line;
+    int index;
+} StringSegment;
+
+// Broadphase over every placed string segment, so a new segment is only tested
+// against the segments around it
+typedef struct StringIndex
+{
+    AabbTree tree;
+    StringSegment *segments;
+    int qtdSegments;
+    int capacity;
+} StringIndex;
+
+void InitStringIndex(StringIndex *index);
+void UnloadStringIndex(StringIndex *index);
+void ClearStringIndex(StringIndex *index);
+void AddStringSegment(StringIndex *index, Vector2 start, Vector2 end, int line, int segment);
+// lines[i] is identified by line id i + 1
+void RebuildStringIndex(StringIndex *index, Points **lines, int qtdLines);
+
+// Crossing rule between two segments, neighbours on the same string only cross when they fold back
+bool StringSegmentsCross(const StringSegment *a, const StringSegment *b);
+bool CheckStringSegmentCrossing(const StringIndex *index, Vector2 start, Vector2 end, int line, int segment);
+// Debug cross-check of the index over every string at once, O(n^2) worst case
+bool FindStringsCrossing(Points **lines, int qtdLines, StringSegment *first, StringSegment *second);
+
+#endif